@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdlib>
+#include <atomic>
+#include <new>
+
+//------------------------------------------------------------------------------
+///Number of heap allocations done through operator new since the program
+///started, used to check that the per-frame loop does not allocate.
+///Counting is enabled by defining SCOLOR_COUNT_ALLOCATIONS, which replaces
+///the global operator new: define it in exactly one translation unit.
+///Memory allocated by C libraries with malloc (e.g. the JPEG encoder working
+///memory) is not counted.
+inline std::atomic< std::size_t >& AllocationCounter() {
+    static std::atomic< std::size_t > count(0);
+    return count;
+}
+
+inline std::size_t AllocationCount() { return AllocationCounter().load(); }
+
+#ifdef SCOLOR_COUNT_ALLOCATIONS
+void* operator new(std::size_t size) {
+    ++AllocationCounter();
+    if(void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+
+void operator delete[](void* p) noexcept { std::free(p); }
+#endif
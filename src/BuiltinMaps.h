@@ -0,0 +1,1185 @@
+#pragma once
+//Generated by mapgen from maps/builtin.txt, do not edit
+#include <string>
+#include <vector>
+
+#include "StaticColormap.h"
+
+namespace builtin {
+//------------------------------------------------------------------------------
+///default colormap
+struct Default {
+    enum {SIZE = 6, HSV = 0};
+    static const char* Id() { return "Default"; }
+    static const double* Colors() {
+        static constexpr double t[] = {
+            1, 1, 1,
+            1, 0.97647058823529409, 0.63921568627450975,
+            1, 0.93725490196078431, 0.058823529411764705,
+            0.94117647058823528, 0.88235294117647056, 0.054901960784313725,
+            1, 0.82352941176470584, 0.12156862745098039,
+            0.94117647058823528, 0.75294117647058822, 0
+        };
+        return t;
+    }
+    static const double* Keys() {
+        static constexpr double t[] = {
+            0, 0.20000000000000001, 0.40000000000000002, 0.59999999999999998,
+            0.80000000000000004, 1
+        };
+        return t;
+    }
+};
+
+//------------------------------------------------------------------------------
+///maps/CoolWarmFloat5.csv
+struct CoolWarmFloat5 {
+    enum {SIZE = 5, HSV = 0};
+    static const char* Id() { return "CoolWarmFloat5"; }
+    static const double* Colors() {
+        static constexpr double t[] = {
+            0.2298057, 0.298717966, 0.75368315299999999,
+            0.55295315599999995, 0.68892933199999995, 0.99537560800000002,
+            0.865395197, 0.86541020999999996, 0.86539556100000004,
+            0.95800306499999999, 0.60284243100000001, 0.48177591400000003,
+            0.70567315799999997, 0.015556159999999999, 0.15023281199999999
+        };
+        return t;
+    }
+    static const double* Keys() {
+        static constexpr double t[] = {
+            0, 0.25, 0.5, 0.75,
+            1
+        };
+        return t;
+    }
+};
+
+//------------------------------------------------------------------------------
+///maps/CoolWarmFloat10.csv
+struct CoolWarmFloat10 {
+    enum {SIZE = 9, HSV = 0};
+    static const char* Id() { return "CoolWarmFloat10"; }
+    static const double* Colors() {
+        static constexpr double t[] = {
+            0.2298057, 0.298717966, 0.75368315299999999,
+            0.38301333999999998, 0.50941904000000005, 0.91738782200000002,
+            0.55295315599999995, 0.68892933199999995, 0.99537560800000002,
+            0.72219329399999999, 0.81395273899999998, 0.97657470899999999,
+            0.865395197, 0.86541020999999996, 0.86539556100000004,
+            0.95885294600000004, 0.76976775200000003, 0.67800794499999995,
+            0.95800306499999999, 0.60284243100000001, 0.48177591400000003,
+            0.86918684899999998, 0.37831309200000002, 0.30026718200000002,
+            0.70567315799999997, 0.015556159999999999, 0.15023281199999999
+        };
+        return t;
+    }
+    static const double* Keys() {
+        static constexpr double t[] = {
+            0, 0.125, 0.25, 0.375,
+            0.5, 0.625, 0.75, 0.875,
+            1
+        };
+        return t;
+    }
+};
+
+//------------------------------------------------------------------------------
+///maps/CoolWarmFloat33.csv
+struct CoolWarmFloat33 {
+    enum {SIZE = 33, HSV = 0};
+    static const char* Id() { return "CoolWarmFloat33"; }
+    static const double* Colors() {
+        static constexpr double t[] = {
+            0.2298057, 0.298717966, 0.75368315299999999,
+            0.26623387999999998, 0.35309483800000002, 0.80146676299999997,
+            0.30386890999999999, 0.40653529599999999, 0.84495867000000002,
+            0.34280447800000002, 0.45875761799999998, 0.88372589899999998,
+            0.38301333999999998, 0.50941904000000005, 0.91738782200000002,
+            0.42436960800000001, 0.55814809200000004, 0.94561958800000001,
+            0.46666708000000001, 0.60456256799999997, 0.96815491099999995,
+            0.50963520399999995, 0.64828077200000001, 0.98478814000000003,
+            0.55295315599999995, 0.68892933199999995, 0.99537560800000002,
+            0.59626216200000004, 0.72614910700000002, 0.99983620299999998,
+            0.63917621099999999, 0.759599947, 0.998151185,
+            0.68129128100000003, 0.78896471199999996, 0.99036322700000001,
+            0.72219329399999999, 0.81395273899999998, 0.97657470899999999,
+            0.76146494899999995, 0.834302879, 0.95694526899999999,
+            0.79869163600000004, 0.84978614200000002, 0.93168864799999995,
+            0.83346655599999997, 0.86020798399999998, 0.90106883800000004,
+            0.865395197, 0.86541020999999996, 0.86539556100000004,
+            0.89778717900000005, 0.84893704699999994, 0.82088054600000004,
+            0.92412759300000002, 0.82738488200000004, 0.77450847199999995,
+            0.94446851799999998, 0.80092744299999996, 0.72673614600000003,
+            0.95885294600000004, 0.76976775200000003, 0.67800794499999995,
+            0.96732803000000001, 0.734132809, 0.62875176300000002,
+            0.96995413699999999, 0.69426668199999997, 0.57937544799999996,
+            0.96681117699999997, 0.65042115599999994, 0.53026376200000003,
+            0.95800306499999999, 0.60284243100000001, 0.48177591400000003,
+            0.94366086599999999, 0.55175096800000001, 0.43424368400000002,
+            0.92394491700000003, 0.49730856000000001, 0.387970225,
+            0.89904616999999998, 0.43955946699999998, 0.34322959600000003,
+            0.86918684899999998, 0.37831309200000002, 0.30026718200000002,
+            0.83462054200000002, 0.31287444599999997, 0.25930119899999998,
+            0.795631745, 0.24128379, 0.220525627,
+            0.75253493400000004, 0.15724606699999999, 0.18411512299999999,
+            0.70567315799999997, 0.015556159999999999, 0.15023281199999999
+        };
+        return t;
+    }
+    static const double* Keys() {
+        static constexpr double t[] = {
+            0, 0.03125, 0.0625, 0.09375,
+            0.125, 0.15625, 0.1875, 0.21875,
+            0.25, 0.28125, 0.3125, 0.34375,
+            0.375, 0.40625, 0.4375, 0.46875,
+            0.5, 0.53125, 0.5625, 0.59375,
+            0.625, 0.65625, 0.6875, 0.71875,
+            0.75, 0.78125, 0.8125, 0.84375,
+            0.875, 0.90625, 0.9375, 0.96875,
+            1
+        };
+        return t;
+    }
+};
+
+//------------------------------------------------------------------------------
+///maps/CoolWarmFloat257.csv
+struct CoolWarmFloat257 {
+    enum {SIZE = 257, HSV = 0};
+    static const char* Id() { return "CoolWarmFloat257"; }
+    static const double* Colors() {
+        static constexpr double t[] = {
+            0.2298057, 0.298717966, 0.75368315299999999,
+            0.23429993499999999, 0.30555920399999997, 0.75987479599999996,
+            0.23881006299999999, 0.31238838499999999, 0.76600586599999998,
+            0.24333666300000001, 0.31920529199999997, 0.77207539400000003,
+            0.24788026499999999, 0.32600965599999998, 0.77808242100000002,
+            0.25244136, 0.33280116500000001, 0.78402600099999997,
+            0.25702039599999998, 0.339579464, 0.789905199,
+            0.26161777899999999, 0.34634416400000001, 0.79571908999999996,
+            0.26623387999999998, 0.35309483800000002, 0.80146676299999997,
+            0.27086902899999998, 0.359831032, 0.80714731500000003,
+            0.27552352299999999, 0.36655226000000002, 0.81275985799999995,
+            0.28019761999999998, 0.37325801400000003, 0.81830351599999995,
+            0.284891546, 0.37994776099999999, 0.82377742200000004,
+            0.28960549499999999, 0.38662094499999999, 0.82918072499999995,
+            0.29433962400000002, 0.39327699300000002, 0.83451258399999995,
+            0.29909406399999999, 0.39991531299999999, 0.83977217100000001,
+            0.30386890999999999, 0.40653529599999999, 0.84495867000000002,
+            0.30866423100000001, 0.41313631899999997, 0.85007127900000001,
+            0.31348006499999997, 0.41971774499999998, 0.85510920700000004,
+            0.31831642199999999, 0.426278924, 0.86007167900000003,
+            0.32317328299999998, 0.43281919400000002, 0.86495792900000001,
+            0.328050603, 0.43933788400000001, 0.86976720699999999,
+            0.33294831200000002, 0.44583431299999998, 0.87449877499999995,
+            0.33786631099999997, 0.45230778999999999, 0.87915191000000004,
+            0.34280447800000002, 0.45875761799999998, 0.88372589899999998,
+            0.34776266700000003, 0.46518309200000002, 0.88822004700000001,
+            0.35274070499999999, 0.47158349900000002, 0.89263366899999996,
+            0.35773839899999998, 0.47795812300000001, 0.89696609500000002,
+            0.36275553199999999, 0.48430624100000003, 0.90121667000000005,
+            0.367791863, 0.490627125, 0.90538475100000004,
+            0.37284713400000002, 0.49692004299999998, 0.90946971099999996,
+            0.37792105999999998, 0.50318426100000002, 0.91347093400000001,
+            0.38301333999999998, 0.50941904000000005, 0.91738782200000002,
+            0.38812364999999999, 0.515623638, 0.92121978800000004,
+            0.39325165000000001, 0.52179731200000001, 0.92496626199999998,
+            0.39839697600000001, 0.52793931599999999, 0.92862668599999998,
+            0.40355924999999998, 0.53404890199999999, 0.93220051800000003,
+            0.40873807400000001, 0.54012532300000005, 0.93568722999999998,
+            0.41393303300000001, 0.54616782900000005, 0.93908630900000001,
+            0.41914369400000001, 0.55217566799999995, 0.94239725699999999,
+            0.42436960800000001, 0.55814809200000004, 0.94561958800000001,
+            0.42961031100000002, 0.56408434900000004, 0.94875283499999996,
+            0.43486532100000003, 0.56998369000000004, 0.95179654300000005,
+            0.440134144, 0.57584536399999997, 0.95475027199999996,
+            0.445416268, 0.581668623, 0.95761359899999998,
+            0.45071116900000002, 0.58745271899999996, 0.96038611299999999,
+            0.45601830799999998, 0.593196905, 0.96306742000000001,
+            0.46133713399999998, 0.59890043599999998, 0.96565714000000002,
+            0.46666708000000001, 0.60456256799999997, 0.96815491099999995,
+            0.47200756900000002, 0.61018256000000004, 0.97056038099999997,
+            0.47735801100000003, 0.61575967200000004, 0.97287321800000004,
+            0.48271780399999997, 0.62129316700000004, 0.97509310199999999,
+            0.48808633600000001, 0.62678231100000004, 0.97721972999999995,
+            0.49346298199999999, 0.63222637100000001, 0.979252813,
+            0.49884710700000001, 0.63762461800000003, 0.98119207799999997,
+            0.50423806599999998, 0.64297632599999999, 0.98303726800000002,
+            0.50963520399999995, 0.64828077200000001, 0.98478814000000003,
+            0.51503785599999996, 0.65353723600000002, 0.98644446699999999,
+            0.52044534899999995, 0.65874500300000005, 0.98800603600000003,
+            0.52585700000000002, 0.66390336000000005, 0.98947265200000001,
+            0.53127211799999996, 0.66901159799999999, 0.99084413199999999,
+            0.536690004, 0.67406901200000002, 0.99212031000000001,
+            0.54210994899999998, 0.67907490299999995, 0.99330103700000005,
+            0.54753123999999997, 0.68402857399999994, 0.99438617699999998,
+            0.55295315599999995, 0.68892933199999995, 0.99537560800000002,
+            0.55837496499999995, 0.69377649200000002, 0.99626922699999998,
+            0.56379593500000003, 0.698569369, 0.99706694500000004,
+            0.56921532200000002, 0.703307287, 0.99776868500000004,
+            0.57463237899999997, 0.70798957200000001, 0.99837438999999994,
+            0.58004635400000004, 0.71261555700000001, 0.99888401599999999,
+            0.585456486, 0.71718457800000002, 0.99929753300000002,
+            0.59086201100000002, 0.72169597900000004, 0.99961492900000004,
+            0.59626216200000004, 0.72614910700000002, 0.99983620299999998,
+            0.60165616499999997, 0.73054331500000003, 0.99996137399999996,
+            0.60704324200000004, 0.73487796400000005, 0.99999047200000002,
+            0.61242260999999998, 0.73915241799999998, 0.99992354400000005,
+            0.61779348499999998, 0.74336604699999997, 0.99976065199999997,
+            0.62315507599999997, 0.74751822800000001, 0.99950187099999999,
+            0.62850659200000003, 0.75160834499999996, 0.99914729300000005,
+            0.63384723700000001, 0.75563578600000003, 0.99869702400000004,
+            0.63917621099999999, 0.759599947, 0.998151185,
+            0.64449271399999997, 0.76350022799999995, 0.99750991,
+            0.64979594200000002, 0.76733603900000003, 0.99677335099999997,
+            0.65508508899999995, 0.77110679299999996, 0.99594167099999997,
+            0.66035934799999996, 0.77481191299999996, 0.99501504900000004,
+            0.66561790799999998, 0.77845082600000004, 0.99399367900000002,
+            0.67085995899999995, 0.78202296800000004, 0.99287776800000005,
+            0.67608468799999999, 0.78552778000000001, 0.99166753900000004,
+            0.68129128100000003, 0.78896471199999996, 0.99036322700000001,
+            0.68647892499999996, 0.79233321899999998, 0.98896508299999997,
+            0.69164680300000003, 0.79563276500000002, 0.98747337099999999,
+            0.696794099, 0.79886282099999995, 0.98588836899999999,
+            0.70191999900000002, 0.802022864, 0.98421036900000003,
+            0.70702368400000004, 0.80511238100000004, 0.98243967700000001,
+            0.71210433900000003, 0.808130864, 0.98057661200000001,
+            0.71716114799999997, 0.81107781400000001, 0.97862150699999995,
+            0.72219329399999999, 0.81395273899999998, 0.97657470899999999,
+            0.72719996200000003, 0.81675515600000004, 0.97443657699999997,
+            0.73218033699999996, 0.81948458999999996, 0.97220748400000001,
+            0.737133606, 0.82214056999999996, 0.96988781599999996,
+            0.74205895600000005, 0.82472263899999998, 0.96747797199999996,
+            0.74695557400000001, 0.82723034399999995, 0.96497836400000003,
+            0.75182265199999998, 0.829663241, 0.962389418,
+            0.75665937900000002, 0.83202089499999998, 0.95971156899999999,
+            0.76146494899999995, 0.834302879, 0.95694526899999999,
+            0.76623855600000002, 0.83650877400000001, 0.95409098000000003,
+            0.77097939699999996, 0.83863816899999999, 0.95114917600000004,
+            0.77568667099999999, 0.84069066199999998, 0.94812034499999998,
+            0.78035957700000003, 0.84266586099999996, 0.94500498499999996,
+            0.78499732, 0.84456337999999997, 0.94180360699999999,
+            0.78959910499999997, 0.846382843, 0.93851673300000005,
+            0.79416414000000002, 0.84812388400000005, 0.935144898,
+            0.79869163600000004, 0.84978614200000002, 0.93168864799999995,
+            0.80318080800000002, 0.85136926999999996, 0.92814853900000005,
+            0.80763087200000006, 0.852872925, 0.92452513999999997,
+            0.81204104799999999, 0.85429677599999998, 0.92081902999999998,
+            0.81641056000000001, 0.85564049900000005, 0.91703079799999998,
+            0.82073863499999999, 0.85690378199999995, 0.913161047,
+            0.82502450299999996, 0.85808631999999996, 0.90921038700000001,
+            0.82926739699999996, 0.85918781600000005, 0.90517943999999995,
+            0.83346655599999997, 0.86020798399999998, 0.90106883800000004,
+            0.83762122100000003, 0.86114654700000004, 0.89687922399999997,
+            0.84173063699999995, 0.86200323599999995, 0.892611249,
+            0.84579405500000004, 0.86277779499999996, 0.888265576,
+            0.84981072700000004, 0.86346997199999997, 0.883842876,
+            0.853779913, 0.86407952700000001, 0.87934383000000005,
+            0.85770087399999995, 0.86460623199999997, 0.87476912799999995,
+            0.86157287800000004, 0.86504986299999997, 0.87011946900000003,
+            0.865395197, 0.86541020999999996, 0.86539556100000004,
+            0.86977749000000004, 0.86363395799999998, 0.85994857599999996,
+            0.874064226, 0.86177635200000002, 0.85446623099999996,
+            0.87825558299999995, 0.85983764399999996, 0.84894943499999997,
+            0.88235172799999995, 0.857818097, 0.84339910100000004,
+            0.88635281799999999, 0.85571797999999999, 0.83781613799999999,
+            0.89025900000000002, 0.85353757299999999, 0.83220145300000004,
+            0.89407040999999998, 0.85127716399999998, 0.82655595400000004,
+            0.89778717900000005, 0.84893704699999994, 0.82088054600000004,
+            0.90140942700000004, 0.84651752800000002, 0.81517613099999997,
+            0.90493726900000004, 0.84401891900000003, 0.80944361099999995,
+            0.90837081600000003, 0.84144154100000002, 0.80368388499999999,
+            0.91171017099999996, 0.83878572200000001, 0.79789785000000002,
+            0.91495543300000004, 0.83605179900000004, 0.79208640100000005,
+            0.91810669600000006, 0.83324011499999995, 0.78625042899999997,
+            0.92116405400000001, 0.83035102299999997, 0.78039082400000004,
+            0.92412759300000002, 0.82738488200000004, 0.77450847199999995,
+            0.92699740100000005, 0.82434205800000004, 0.76860425700000001,
+            0.92977356200000005, 0.82122292600000002, 0.76267905999999996,
+            0.93245615900000001, 0.81802786500000002, 0.75673375799999998,
+            0.93504527199999998, 0.81475726400000004, 0.75076922599999996,
+            0.93754098399999997, 0.81141151700000003, 0.74478633299999997,
+            0.93994337500000003, 0.80799102499999997, 0.738785947,
+            0.94225252599999998, 0.804496196, 0.73276893099999996,
+            0.94446851799999998, 0.80092744299999996, 0.72673614600000003,
+            0.94659143400000001, 0.79728518699999995, 0.72068844600000004,
+            0.94862135700000005, 0.79356985300000005, 0.71462668299999998,
+            0.95055837300000001, 0.78978187200000005, 0.70855170599999995,
+            0.95240256700000003, 0.78592168200000001, 0.70246435600000001,
+            0.95415402900000001, 0.78198972499999997, 0.69636547299999996,
+            0.95581284899999996, 0.77798644900000002, 0.69025589099999995,
+            0.95737912300000005, 0.77391230499999997, 0.68413643999999996,
+            0.95885294600000004, 0.76976775200000003, 0.67800794499999995,
+            0.96023441799999998, 0.76555325100000005, 0.67187122600000004,
+            0.96152364199999996, 0.76126926699999997, 0.66572709799999996,
+            0.96272072500000005, 0.756916272, 0.65957637199999997,
+            0.96382577700000005, 0.752494738, 0.65341985300000005,
+            0.96483891300000002, 0.74800514299999998, 0.64725834100000001,
+            0.96576025099999996, 0.74344796700000004, 0.64109263000000005,
+            0.96658991400000005, 0.73882369299999995, 0.63492350900000005,
+            0.96732803000000001, 0.734132809, 0.62875176300000002,
+            0.96797472900000003, 0.72937580199999996, 0.62257817000000004,
+            0.96853014999999998, 0.72455316199999997, 0.61640350200000005,
+            0.96899443500000004, 0.71966538300000005, 0.61022852500000002,
+            0.96936772900000001, 0.71471295599999995, 0.60405400200000003,
+            0.96965018599999997, 0.70969637799999996, 0.59788068599999999,
+            0.96984196300000003, 0.70461614299999997, 0.59170932799999998,
+            0.96994322399999999, 0.69947274599999998, 0.58554066900000001,
+            0.96995413699999999, 0.69426668199999997, 0.57937544799999996,
+            0.96987487800000005, 0.68899844700000001, 0.57321439399999996,
+            0.96970562599999999, 0.683668532, 0.56705823200000005,
+            0.96944657000000001, 0.67827743100000004, 0.56090768099999999,
+            0.96909790100000004, 0.67282563299999998, 0.55476345199999999,
+            0.96865981800000001, 0.66731362400000005, 0.54862624999999998,
+            0.96813252800000005, 0.66174188899999997, 0.54249677399999996,
+            0.967516241, 0.65611090800000005, 0.536375716,
+            0.96681117699999997, 0.65042115599999994, 0.53026376200000003,
+            0.96601755899999997, 0.644673104, 0.52416159100000004,
+            0.96513562100000005, 0.63886721599999996, 0.51806987500000001,
+            0.96416559899999998, 0.63300394999999998, 0.51198927900000002,
+            0.96310773900000002, 0.62708375800000005, 0.50592046199999996,
+            0.96196229300000002, 0.62110708199999998, 0.49986407500000002,
+            0.96072952099999998, 0.61507435499999996, 0.49382076400000002,
+            0.95940968699999996, 0.60898600000000003, 0.48779116700000003,
+            0.95800306499999999, 0.60284243100000001, 0.48177591400000003,
+            0.95650993600000001, 0.59664404599999998, 0.47577562899999998,
+            0.95493058600000003, 0.59039123199999999, 0.46979093,
+            0.95326531000000003, 0.58408436100000005, 0.46382242600000001,
+            0.951514411, 0.57772378999999996, 0.45787071899999998,
+            0.94967819600000003, 0.57130985599999995, 0.45193640699999998,
+            0.947756983, 0.56484287899999996, 0.44602007700000001,
+            0.94575109599999996, 0.55832315799999999, 0.44012231200000002,
+            0.94366086599999999, 0.55175096800000001, 0.43424368400000002,
+            0.94148663099999996, 0.54512656199999998, 0.428384763,
+            0.93922873900000003, 0.53845016499999998, 0.422546107,
+            0.93688754299999999, 0.53172197200000004, 0.41672827000000001,
+            0.93446340400000005, 0.52494214699999997, 0.41093179800000001,
+            0.931956691, 0.51811082100000005, 0.40515722999999998,
+            0.92936778200000003, 0.511228087, 0.39940509600000001,
+            0.92669705999999996, 0.50429399699999999, 0.39367592200000001,
+            0.92394491700000003, 0.49730856000000001, 0.387970225,
+            0.92111175300000003, 0.49027173499999999, 0.38228851600000002,
+            0.91819797400000003, 0.483183431, 0.37663129699999998,
+            0.91520399600000002, 0.47604349800000001, 0.37099906500000002,
+            0.91213024099999995, 0.46885172400000003, 0.36539231,
+            0.90897713899999999, 0.46160783100000002, 0.35981151300000003,
+            0.90574512799999995, 0.454311462, 0.35425715099999999,
+            0.902434654, 0.44696218300000001, 0.34872969100000001,
+            0.89904616999999998, 0.43955946699999998, 0.34322959600000003,
+            0.89558013599999997, 0.43210269000000001, 0.33775732000000003,
+            0.89203702200000001, 0.42459111799999999, 0.332313313,
+            0.88841730299999999, 0.417023898, 0.32689801600000001,
+            0.88472146399999996, 0.40940004499999999, 0.32151186300000001,
+            0.88094999600000001, 0.40171842499999999, 0.31615528399999998,
+            0.87710339900000001, 0.39397774499999999, 0.31082870200000001,
+            0.87318217799999998, 0.38617652699999999, 0.305532531,
+            0.86918684899999998, 0.37831309200000002, 0.30026718200000002,
+            0.86511793400000003, 0.37038553499999999, 0.29503305899999999,
+            0.86097596200000004, 0.36239169500000001, 0.28983055899999999,
+            0.85676147000000002, 0.35432912700000002, 0.28466007500000001,
+            0.85247500399999998, 0.34619506100000003, 0.27952199100000003,
+            0.84811711400000001, 0.33798636100000001, 0.27441669000000002,
+            0.843688361, 0.32969947100000002, 0.26934454499999999,
+            0.83918931200000002, 0.32133035999999998, 0.264305927,
+            0.83462054200000002, 0.31287444599999997, 0.25930119899999998,
+            0.82998263100000003, 0.30432651300000002, 0.25433072299999998,
+            0.82527616999999998, 0.29568061099999998, 0.249394851,
+            0.82050175400000003, 0.286929926, 0.244493934,
+            0.81565998799999995, 0.27806663599999998, 0.23962831800000001,
+            0.81075148200000002, 0.269081721, 0.23479834299999999,
+            0.80577685499999996, 0.259964733, 0.230004348,
+            0.80073673199999995, 0.25070350699999999, 0.22524666600000001,
+            0.795631745, 0.24128379, 0.220525627,
+            0.79046253300000002, 0.23168876799999999, 0.21584155799999999,
+            0.78522974400000001, 0.221898442, 0.211194782,
+            0.77993402899999997, 0.21188881300000001, 0.20658562,
+            0.77457605100000004, 0.20163076199999999, 0.20201439199999999,
+            0.76915647399999998, 0.19108851800000001, 0.19748141399999999,
+            0.76367597499999995, 0.18021748800000001, 0.19298700099999999,
+            0.75813523199999999, 0.168961101, 0.18853146700000001,
+            0.75253493400000004, 0.15724606699999999, 0.18411512299999999,
+            0.74687577299999997, 0.14497495599999999, 0.179738284,
+            0.74115845199999997, 0.13201401700000001, 0.175401259,
+            0.73538367500000001, 0.1181719, 0.17110436300000001,
+            0.72955215699999998, 0.10315940899999999, 0.16684790699999999,
+            0.72366461800000004, 0.086504693999999993, 0.162632207,
+            0.71772178200000003, 0.067344035999999996, 0.15845757799999999,
+            0.71172438299999996, 0.043755173000000001, 0.154324339,
+            0.70567315799999997, 0.015556159999999999, 0.15023281199999999
+        };
+        return t;
+    }
+    static const double* Keys() {
+        static constexpr double t[] = {
+            0, 0.00390625, 0.0078125, 0.01171875,
+            0.015625, 0.01953125, 0.0234375, 0.02734375,
+            0.03125, 0.03515625, 0.0390625, 0.04296875,
+            0.046875, 0.05078125, 0.0546875, 0.05859375,
+            0.0625, 0.06640625, 0.0703125, 0.07421875,
+            0.078125, 0.08203125, 0.0859375, 0.08984375,
+            0.09375, 0.09765625, 0.1015625, 0.10546875,
+            0.109375, 0.11328125, 0.1171875, 0.12109375,
+            0.125, 0.12890625, 0.1328125, 0.13671875,
+            0.140625, 0.14453125, 0.1484375, 0.15234375,
+            0.15625, 0.16015625, 0.1640625, 0.16796875,
+            0.171875, 0.17578125, 0.1796875, 0.18359375,
+            0.1875, 0.19140625, 0.1953125, 0.19921875,
+            0.203125, 0.20703125, 0.2109375, 0.21484375,
+            0.21875, 0.22265625, 0.2265625, 0.23046875,
+            0.234375, 0.23828125, 0.2421875, 0.24609375,
+            0.25, 0.25390625, 0.2578125, 0.26171875,
+            0.265625, 0.26953125, 0.2734375, 0.27734375,
+            0.28125, 0.28515625, 0.2890625, 0.29296875,
+            0.296875, 0.30078125, 0.3046875, 0.30859375,
+            0.3125, 0.31640625, 0.3203125, 0.32421875,
+            0.328125, 0.33203125, 0.3359375, 0.33984375,
+            0.34375, 0.34765625, 0.3515625, 0.35546875,
+            0.359375, 0.36328125, 0.3671875, 0.37109375,
+            0.375, 0.37890625, 0.3828125, 0.38671875,
+            0.390625, 0.39453125, 0.3984375, 0.40234375,
+            0.40625, 0.41015625, 0.4140625, 0.41796875,
+            0.421875, 0.42578125, 0.4296875, 0.43359375,
+            0.4375, 0.44140625, 0.4453125, 0.44921875,
+            0.453125, 0.45703125, 0.4609375, 0.46484375,
+            0.46875, 0.47265625, 0.4765625, 0.48046875,
+            0.484375, 0.48828125, 0.4921875, 0.49609375,
+            0.5, 0.50390625, 0.5078125, 0.51171875,
+            0.515625, 0.51953125, 0.5234375, 0.52734375,
+            0.53125, 0.53515625, 0.5390625, 0.54296875,
+            0.546875, 0.55078125, 0.5546875, 0.55859375,
+            0.5625, 0.56640625, 0.5703125, 0.57421875,
+            0.578125, 0.58203125, 0.5859375, 0.58984375,
+            0.59375, 0.59765625, 0.6015625, 0.60546875,
+            0.609375, 0.61328125, 0.6171875, 0.62109375,
+            0.625, 0.62890625, 0.6328125, 0.63671875,
+            0.640625, 0.64453125, 0.6484375, 0.65234375,
+            0.65625, 0.66015625, 0.6640625, 0.66796875,
+            0.671875, 0.67578125, 0.6796875, 0.68359375,
+            0.6875, 0.69140625, 0.6953125, 0.69921875,
+            0.703125, 0.70703125, 0.7109375, 0.71484375,
+            0.71875, 0.72265625, 0.7265625, 0.73046875,
+            0.734375, 0.73828125, 0.7421875, 0.74609375,
+            0.75, 0.75390625, 0.7578125, 0.76171875,
+            0.765625, 0.76953125, 0.7734375, 0.77734375,
+            0.78125, 0.78515625, 0.7890625, 0.79296875,
+            0.796875, 0.80078125, 0.8046875, 0.80859375,
+            0.8125, 0.81640625, 0.8203125, 0.82421875,
+            0.828125, 0.83203125, 0.8359375, 0.83984375,
+            0.84375, 0.84765625, 0.8515625, 0.85546875,
+            0.859375, 0.86328125, 0.8671875, 0.87109375,
+            0.875, 0.87890625, 0.8828125, 0.88671875,
+            0.890625, 0.89453125, 0.8984375, 0.90234375,
+            0.90625, 0.91015625, 0.9140625, 0.91796875,
+            0.921875, 0.92578125, 0.9296875, 0.93359375,
+            0.9375, 0.94140625, 0.9453125, 0.94921875,
+            0.953125, 0.95703125, 0.9609375, 0.96484375,
+            0.96875, 0.97265625, 0.9765625, 0.98046875,
+            0.984375, 0.98828125, 0.9921875, 0.99609375,
+            1
+        };
+        return t;
+    }
+};
+
+//------------------------------------------------------------------------------
+///maps/CoolWarmUChar33.csv
+struct CoolWarmUChar33 {
+    enum {SIZE = 33, HSV = 0};
+    static const char* Id() { return "CoolWarmUChar33"; }
+    static const double* Colors() {
+        static constexpr double t[] = {
+            0.23137254901960785, 0.29803921568627451, 0.75294117647058822,
+            0.26666666666666666, 0.3529411764705882, 0.80000000000000004,
+            0.30196078431372547, 0.40784313725490196, 0.84313725490196079,
+            0.3411764705882353, 0.45882352941176469, 0.88235294117647056,
+            0.38431372549019605, 0.50980392156862742, 0.91764705882352937,
+            0.42352941176470588, 0.55686274509803924, 0.94509803921568625,
+            0.46666666666666667, 0.60392156862745094, 0.96862745098039216,
+            0.50980392156862742, 0.6470588235294118, 0.98431372549019602,
+            0.55294117647058827, 0.69019607843137254, 0.99607843137254903,
+            0.59607843137254901, 0.72549019607843135, 1,
+            0.63921568627450975, 0.76078431372549016, 1,
+            0.68235294117647061, 0.78823529411764703, 0.99215686274509807,
+            0.72156862745098038, 0.81568627450980391, 0.97647058823529409,
+            0.76078431372549016, 0.83529411764705885, 0.95686274509803915,
+            0.80000000000000004, 0.85098039215686272, 0.93333333333333335,
+            0.83529411764705885, 0.85882352941176465, 0.90196078431372551,
+            0.8666666666666667, 0.8666666666666667, 0.8666666666666667,
+            0.89803921568627454, 0.84705882352941175, 0.81960784313725488,
+            0.92549019607843142, 0.82745098039215681, 0.77254901960784317,
+            0.94509803921568625, 0.80000000000000004, 0.72549019607843135,
+            0.96078431372549022, 0.76862745098039209, 0.67843137254901964,
+            0.96862745098039216, 0.73333333333333328, 0.62745098039215685,
+            0.96862745098039216, 0.69411764705882351, 0.58039215686274503,
+            0.96862745098039216, 0.65098039215686276, 0.52941176470588236,
+            0.95686274509803915, 0.60392156862745094, 0.4823529411764706,
+            0.94509803921568625, 0.55294117647058827, 0.43529411764705883,
+            0.92549019607843142, 0.49803921568627452, 0.38823529411764707,
+            0.89803921568627454, 0.4392156862745098, 0.34509803921568627,
+            0.87058823529411766, 0.37647058823529411, 0.30196078431372547,
+            0.83529411764705885, 0.31372549019607843, 0.25882352941176467,
+            0.79607843137254897, 0.24313725490196078, 0.2196078431372549,
+            0.75294117647058822, 0.15686274509803921, 0.18431372549019609,
+            0.70588235294117641, 0.015686274509803921, 0.14901960784313725
+        };
+        return t;
+    }
+    static const double* Keys() {
+        static constexpr double t[] = {
+            0, 0.03125, 0.0625, 0.09375,
+            0.125, 0.15625, 0.1875, 0.21875,
+            0.25, 0.28125, 0.3125, 0.34375,
+            0.375, 0.40625, 0.4375, 0.46875,
+            0.5, 0.53125, 0.5625, 0.59375,
+            0.625, 0.65625, 0.6875, 0.71875,
+            0.75, 0.78125, 0.8125, 0.84375,
+            0.875, 0.90625, 0.9375, 0.96875,
+            1
+        };
+        return t;
+    }
+};
+
+//------------------------------------------------------------------------------
+///maps/CoolWarmUChar257.csv
+struct CoolWarmUChar257 {
+    enum {SIZE = 257, HSV = 0};
+    static const char* Id() { return "CoolWarmUChar257"; }
+    static const double* Colors() {
+        static constexpr double t[] = {
+            0.23137254901960785, 0.29803921568627451, 0.75294117647058822,
+            0.23529411764705882, 0.30588235294117649, 0.76078431372549016,
+            0.23921568627450979, 0.31372549019607843, 0.76470588235294112,
+            0.24313725490196078, 0.31764705882352939, 0.77254901960784317,
+            0.24705882352941178, 0.32549019607843138, 0.77647058823529413,
+            0.25098039215686274, 0.33333333333333331, 0.78431372549019607,
+            0.25882352941176467, 0.3411764705882353, 0.78823529411764703,
+            0.2627450980392157, 0.34509803921568627, 0.79607843137254897,
+            0.26666666666666666, 0.3529411764705882, 0.80000000000000004,
+            0.27058823529411763, 0.36078431372549019, 0.80784313725490198,
+            0.27450980392156865, 0.36470588235294116, 0.81176470588235294,
+            0.27843137254901962, 0.37254901960784315, 0.81960784313725488,
+            0.28627450980392155, 0.38039215686274508, 0.82352941176470584,
+            0.29019607843137252, 0.38823529411764707, 0.82745098039215681,
+            0.29411764705882354, 0.39215686274509803, 0.83529411764705885,
+            0.29803921568627451, 0.40000000000000002, 0.83921568627450982,
+            0.30196078431372547, 0.40784313725490196, 0.84313725490196079,
+            0.30980392156862746, 0.41176470588235292, 0.85098039215686272,
+            0.31372549019607843, 0.41960784313725491, 0.85490196078431369,
+            0.31764705882352939, 0.42745098039215684, 0.85882352941176465,
+            0.32156862745098036, 0.43137254901960786, 0.8666666666666667,
+            0.32941176470588235, 0.4392156862745098, 0.87058823529411766,
+            0.33333333333333331, 0.44705882352941173, 0.87450980392156863,
+            0.33725490196078434, 0.45098039215686275, 0.8784313725490196,
+            0.3411764705882353, 0.45882352941176469, 0.88235294117647056,
+            0.34901960784313724, 0.46666666666666667, 0.88627450980392153,
+            0.3529411764705882, 0.47058823529411764, 0.89411764705882346,
+            0.35686274509803922, 0.47843137254901957, 0.89803921568627454,
+            0.36470588235294116, 0.4823529411764706, 0.90196078431372551,
+            0.36862745098039218, 0.49019607843137253, 0.90588235294117647,
+            0.37254901960784315, 0.49803921568627452, 0.90980392156862744,
+            0.37647058823529411, 0.50196078431372548, 0.9137254901960784,
+            0.38431372549019605, 0.50980392156862742, 0.91764705882352937,
+            0.38823529411764707, 0.51372549019607838, 0.92156862745098034,
+            0.39215686274509803, 0.52156862745098043, 0.92549019607843142,
+            0.40000000000000002, 0.52941176470588236, 0.92941176470588238,
+            0.40392156862745099, 0.53333333333333333, 0.93333333333333335,
+            0.40784313725490196, 0.54117647058823526, 0.93725490196078431,
+            0.41568627450980389, 0.54509803921568623, 0.93725490196078431,
+            0.41960784313725491, 0.55294117647058827, 0.94117647058823528,
+            0.42352941176470588, 0.55686274509803924, 0.94509803921568625,
+            0.43137254901960786, 0.56470588235294117, 0.94901960784313721,
+            0.43529411764705883, 0.56862745098039214, 0.95294117647058818,
+            0.4392156862745098, 0.57647058823529407, 0.95294117647058818,
+            0.44705882352941173, 0.58039215686274503, 0.95686274509803915,
+            0.45098039215686275, 0.58823529411764708, 0.96078431372549022,
+            0.45490196078431372, 0.59215686274509804, 0.96470588235294119,
+            0.46274509803921571, 0.59999999999999998, 0.96470588235294119,
+            0.46666666666666667, 0.60392156862745094, 0.96862745098039216,
+            0.47058823529411764, 0.61176470588235299, 0.96862745098039216,
+            0.47843137254901957, 0.61568627450980395, 0.97254901960784312,
+            0.4823529411764706, 0.61960784313725492, 0.97647058823529409,
+            0.48627450980392156, 0.62745098039215685, 0.97647058823529409,
+            0.49411764705882355, 0.63137254901960782, 0.98039215686274506,
+            0.49803921568627452, 0.63921568627450975, 0.98039215686274506,
+            0.50588235294117645, 0.64313725490196072, 0.98431372549019602,
+            0.50980392156862742, 0.6470588235294118, 0.98431372549019602,
+            0.51372549019607838, 0.65490196078431373, 0.9882352941176471,
+            0.52156862745098043, 0.6588235294117647, 0.9882352941176471,
+            0.52549019607843139, 0.66274509803921566, 0.9882352941176471,
+            0.52941176470588236, 0.6705882352941176, 0.99215686274509807,
+            0.53725490196078429, 0.67450980392156867, 0.99215686274509807,
+            0.54117647058823526, 0.67843137254901964, 0.99215686274509807,
+            0.5490196078431373, 0.68235294117647061, 0.99607843137254903,
+            0.55294117647058827, 0.69019607843137254, 0.99607843137254903,
+            0.55686274509803924, 0.69411764705882351, 0.99607843137254903,
+            0.56470588235294117, 0.69803921568627447, 0.99607843137254903,
+            0.56862745098039214, 0.70196078431372544, 0.99607843137254903,
+            0.57647058823529407, 0.70980392156862748, 1,
+            0.58039215686274503, 0.71372549019607845, 1,
+            0.58431372549019611, 0.71764705882352942, 1,
+            0.59215686274509804, 0.72156862745098038, 1,
+            0.59607843137254901, 0.72549019607843135, 1,
+            0.59999999999999998, 0.72941176470588232, 1,
+            0.60784313725490191, 0.73333333333333328, 1,
+            0.61176470588235299, 0.73725490196078436, 1,
+            0.61960784313725492, 0.74509803921568629, 1,
+            0.62352941176470589, 0.74901960784313726, 1,
+            0.62745098039215685, 0.75294117647058822, 1,
+            0.63529411764705879, 0.75686274509803919, 1,
+            0.63921568627450975, 0.76078431372549016, 1,
+            0.64313725490196072, 0.76470588235294112, 0.99607843137254903,
+            0.65098039215686276, 0.76862745098039209, 0.99607843137254903,
+            0.65490196078431373, 0.77254901960784317, 0.99607843137254903,
+            0.6588235294117647, 0.77647058823529413, 0.99607843137254903,
+            0.66666666666666663, 0.7803921568627451, 0.99215686274509807,
+            0.6705882352941176, 0.7803921568627451, 0.99215686274509807,
+            0.67450980392156867, 0.78431372549019607, 0.99215686274509807,
+            0.68235294117647061, 0.78823529411764703, 0.99215686274509807,
+            0.68627450980392157, 0.792156862745098, 0.9882352941176471,
+            0.69019607843137254, 0.79607843137254897, 0.9882352941176471,
+            0.69803921568627447, 0.80000000000000004, 0.98431372549019602,
+            0.70196078431372544, 0.80392156862745101, 0.98431372549019602,
+            0.70588235294117641, 0.80392156862745101, 0.98431372549019602,
+            0.71372549019607845, 0.80784313725490198, 0.98039215686274506,
+            0.71764705882352942, 0.81176470588235294, 0.98039215686274506,
+            0.72156862745098038, 0.81568627450980391, 0.97647058823529409,
+            0.72549019607843135, 0.81568627450980391, 0.97254901960784312,
+            0.73333333333333328, 0.81960784313725488, 0.97254901960784312,
+            0.73725490196078436, 0.82352941176470584, 0.96862745098039216,
+            0.74117647058823533, 0.82352941176470584, 0.96862745098039216,
+            0.74509803921568629, 0.82745098039215681, 0.96470588235294119,
+            0.75294117647058822, 0.83137254901960778, 0.96078431372549022,
+            0.75686274509803919, 0.83137254901960778, 0.96078431372549022,
+            0.76078431372549016, 0.83529411764705885, 0.95686274509803915,
+            0.76470588235294112, 0.83529411764705885, 0.95294117647058818,
+            0.77254901960784317, 0.83921568627450982, 0.95294117647058818,
+            0.77647058823529413, 0.83921568627450982, 0.94901960784313721,
+            0.7803921568627451, 0.84313725490196079, 0.94509803921568625,
+            0.78431372549019607, 0.84313725490196079, 0.94117647058823528,
+            0.78823529411764703, 0.84705882352941175, 0.93725490196078431,
+            0.79607843137254897, 0.84705882352941175, 0.93333333333333335,
+            0.80000000000000004, 0.85098039215686272, 0.93333333333333335,
+            0.80392156862745101, 0.85098039215686272, 0.92941176470588238,
+            0.80784313725490198, 0.85098039215686272, 0.92549019607843142,
+            0.81176470588235294, 0.85490196078431369, 0.92156862745098034,
+            0.81568627450980391, 0.85490196078431369, 0.91764705882352937,
+            0.81960784313725488, 0.85882352941176465, 0.9137254901960784,
+            0.82352941176470584, 0.85882352941176465, 0.90980392156862744,
+            0.82745098039215681, 0.85882352941176465, 0.90588235294117647,
+            0.83529411764705885, 0.85882352941176465, 0.90196078431372551,
+            0.83921568627450982, 0.86274509803921573, 0.89803921568627454,
+            0.84313725490196079, 0.86274509803921573, 0.89411764705882346,
+            0.84705882352941175, 0.86274509803921573, 0.8901960784313725,
+            0.85098039215686272, 0.86274509803921573, 0.88235294117647056,
+            0.85490196078431369, 0.86274509803921573, 0.8784313725490196,
+            0.85882352941176465, 0.86274509803921573, 0.87450980392156863,
+            0.86274509803921573, 0.8666666666666667, 0.87058823529411766,
+            0.8666666666666667, 0.8666666666666667, 0.8666666666666667,
+            0.87058823529411766, 0.86274509803921573, 0.85882352941176465,
+            0.87450980392156863, 0.86274509803921573, 0.85490196078431369,
+            0.8784313725490196, 0.85882352941176465, 0.84705882352941175,
+            0.88235294117647056, 0.85882352941176465, 0.84313725490196079,
+            0.88627450980392153, 0.85490196078431369, 0.83921568627450982,
+            0.8901960784313725, 0.85490196078431369, 0.83137254901960778,
+            0.89411764705882346, 0.85098039215686272, 0.82745098039215681,
+            0.89803921568627454, 0.84705882352941175, 0.81960784313725488,
+            0.90196078431372551, 0.84705882352941175, 0.81568627450980391,
+            0.90588235294117647, 0.84313725490196079, 0.80784313725490198,
+            0.90980392156862744, 0.84313725490196079, 0.80392156862745101,
+            0.90980392156862744, 0.83921568627450982, 0.79607843137254897,
+            0.9137254901960784, 0.83529411764705885, 0.792156862745098,
+            0.91764705882352937, 0.83137254901960778, 0.78431372549019607,
+            0.92156862745098034, 0.83137254901960778, 0.7803921568627451,
+            0.92549019607843142, 0.82745098039215681, 0.77254901960784317,
+            0.92549019607843142, 0.82352941176470584, 0.76862745098039209,
+            0.92941176470588238, 0.81960784313725488, 0.76078431372549016,
+            0.93333333333333335, 0.81960784313725488, 0.75686274509803919,
+            0.93333333333333335, 0.81568627450980391, 0.74901960784313726,
+            0.93725490196078431, 0.81176470588235294, 0.74509803921568629,
+            0.94117647058823528, 0.80784313725490198, 0.73725490196078436,
+            0.94117647058823528, 0.80392156862745101, 0.73333333333333328,
+            0.94509803921568625, 0.80000000000000004, 0.72549019607843135,
+            0.94509803921568625, 0.79607843137254897, 0.72156862745098038,
+            0.94901960784313721, 0.792156862745098, 0.71372549019607845,
+            0.94901960784313721, 0.78823529411764703, 0.70980392156862748,
+            0.95294117647058818, 0.78431372549019607, 0.70196078431372544,
+            0.95294117647058818, 0.7803921568627451, 0.69803921568627447,
+            0.95686274509803915, 0.77647058823529413, 0.69019607843137254,
+            0.95686274509803915, 0.77254901960784317, 0.68235294117647061,
+            0.96078431372549022, 0.76862745098039209, 0.67843137254901964,
+            0.96078431372549022, 0.76470588235294112, 0.6705882352941176,
+            0.96078431372549022, 0.76078431372549016, 0.66666666666666663,
+            0.96078431372549022, 0.75686274509803919, 0.6588235294117647,
+            0.96470588235294119, 0.75294117647058822, 0.65490196078431373,
+            0.96470588235294119, 0.74901960784313726, 0.6470588235294118,
+            0.96470588235294119, 0.74509803921568629, 0.63921568627450975,
+            0.96470588235294119, 0.73725490196078436, 0.63529411764705879,
+            0.96862745098039216, 0.73333333333333328, 0.62745098039215685,
+            0.96862745098039216, 0.72941176470588232, 0.62352941176470589,
+            0.96862745098039216, 0.72549019607843135, 0.61568627450980395,
+            0.96862745098039216, 0.72156862745098038, 0.61176470588235299,
+            0.96862745098039216, 0.71372549019607845, 0.60392156862745094,
+            0.96862745098039216, 0.70980392156862748, 0.59607843137254901,
+            0.96862745098039216, 0.70588235294117641, 0.59215686274509804,
+            0.96862745098039216, 0.69803921568627447, 0.58431372549019611,
+            0.96862745098039216, 0.69411764705882351, 0.58039215686274503,
+            0.96862745098039216, 0.69019607843137254, 0.5725490196078431,
+            0.96862745098039216, 0.68235294117647061, 0.56862745098039214,
+            0.96862745098039216, 0.67843137254901964, 0.5607843137254902,
+            0.96862745098039216, 0.67450980392156867, 0.55294117647058827,
+            0.96862745098039216, 0.66666666666666663, 0.5490196078431373,
+            0.96862745098039216, 0.66274509803921566, 0.54117647058823526,
+            0.96862745098039216, 0.65490196078431373, 0.53725490196078429,
+            0.96862745098039216, 0.65098039215686276, 0.52941176470588236,
+            0.96470588235294119, 0.64313725490196072, 0.52549019607843139,
+            0.96470588235294119, 0.63921568627450975, 0.51764705882352935,
+            0.96470588235294119, 0.63137254901960782, 0.51372549019607838,
+            0.96470588235294119, 0.62745098039215685, 0.50588235294117645,
+            0.96078431372549022, 0.61960784313725492, 0.49803921568627452,
+            0.96078431372549022, 0.61568627450980395, 0.49411764705882355,
+            0.96078431372549022, 0.60784313725490191, 0.48627450980392156,
+            0.95686274509803915, 0.60392156862745094, 0.4823529411764706,
+            0.95686274509803915, 0.59607843137254901, 0.47450980392156861,
+            0.95686274509803915, 0.59215686274509804, 0.47058823529411764,
+            0.95294117647058818, 0.58431372549019611, 0.46274509803921571,
+            0.95294117647058818, 0.57647058823529407, 0.45882352941176469,
+            0.94901960784313721, 0.5725490196078431, 0.45098039215686275,
+            0.94901960784313721, 0.56470588235294117, 0.44705882352941173,
+            0.94509803921568625, 0.55686274509803924, 0.4392156862745098,
+            0.94509803921568625, 0.55294117647058827, 0.43529411764705883,
+            0.94117647058823528, 0.54509803921568623, 0.42745098039215684,
+            0.94117647058823528, 0.53725490196078429, 0.42352941176470588,
+            0.93725490196078431, 0.53333333333333333, 0.41568627450980389,
+            0.93333333333333335, 0.52549019607843139, 0.41176470588235292,
+            0.93333333333333335, 0.51764705882352935, 0.40392156862745099,
+            0.92941176470588238, 0.50980392156862742, 0.40000000000000002,
+            0.92549019607843142, 0.50588235294117645, 0.39215686274509803,
+            0.92549019607843142, 0.49803921568627452, 0.38823529411764707,
+            0.92156862745098034, 0.49019607843137253, 0.38039215686274508,
+            0.91764705882352937, 0.4823529411764706, 0.37647058823529411,
+            0.9137254901960784, 0.47450980392156861, 0.37254901960784315,
+            0.9137254901960784, 0.47058823529411764, 0.36470588235294116,
+            0.90980392156862744, 0.46274509803921571, 0.36078431372549019,
+            0.90588235294117647, 0.45490196078431372, 0.3529411764705882,
+            0.90196078431372551, 0.44705882352941173, 0.34901960784313724,
+            0.89803921568627454, 0.4392156862745098, 0.34509803921568627,
+            0.89411764705882346, 0.43137254901960786, 0.33725490196078434,
+            0.8901960784313725, 0.42352941176470588, 0.33333333333333331,
+            0.8901960784313725, 0.41568627450980389, 0.32549019607843138,
+            0.88627450980392153, 0.40784313725490196, 0.32156862745098036,
+            0.88235294117647056, 0.40000000000000002, 0.31764705882352939,
+            0.8784313725490196, 0.39215686274509803, 0.30980392156862746,
+            0.87450980392156863, 0.38431372549019605, 0.30588235294117649,
+            0.87058823529411766, 0.37647058823529411, 0.30196078431372547,
+            0.8666666666666667, 0.36862745098039218, 0.29411764705882354,
+            0.86274509803921573, 0.36078431372549019, 0.29019607843137252,
+            0.85490196078431369, 0.3529411764705882, 0.28627450980392155,
+            0.85098039215686272, 0.34509803921568627, 0.27843137254901962,
+            0.84705882352941175, 0.33725490196078434, 0.27450980392156865,
+            0.84313725490196079, 0.32941176470588235, 0.27058823529411763,
+            0.83921568627450982, 0.32156862745098036, 0.2627450980392157,
+            0.83529411764705885, 0.31372549019607843, 0.25882352941176467,
+            0.83137254901960778, 0.30588235294117649, 0.25490196078431371,
+            0.82352941176470584, 0.29411764705882354, 0.25098039215686274,
+            0.81960784313725488, 0.28627450980392155, 0.24313725490196078,
+            0.81568627450980391, 0.27843137254901962, 0.23921568627450979,
+            0.81176470588235294, 0.27058823529411763, 0.23529411764705882,
+            0.80392156862745101, 0.25882352941176467, 0.23137254901960785,
+            0.80000000000000004, 0.25098039215686274, 0.22352941176470587,
+            0.79607843137254897, 0.24313725490196078, 0.2196078431372549,
+            0.792156862745098, 0.23137254901960785, 0.21568627450980393,
+            0.78431372549019607, 0.22352941176470587, 0.21176470588235294,
+            0.7803921568627451, 0.21176470588235294, 0.20784313725490194,
+            0.77647058823529413, 0.20000000000000001, 0.20392156862745098,
+            0.76862745098039209, 0.19215686274509802, 0.19607843137254902,
+            0.76470588235294112, 0.1803921568627451, 0.19215686274509802,
+            0.75686274509803919, 0.16862745098039217, 0.18823529411764706,
+            0.75294117647058822, 0.15686274509803921, 0.18431372549019609,
+            0.74509803921568629, 0.14509803921568626, 0.1803921568627451,
+            0.74117647058823533, 0.13333333333333333, 0.1764705882352941,
+            0.73725490196078436, 0.11764705882352941, 0.17254901960784313,
+            0.72941176470588232, 0.10196078431372549, 0.16862745098039217,
+            0.72549019607843135, 0.086274509803921567, 0.16078431372549018,
+            0.71764705882352942, 0.066666666666666666, 0.15686274509803921,
+            0.70980392156862748, 0.043137254901960784, 0.15294117647058825,
+            0.70588235294117641, 0.015686274509803921, 0.14901960784313725
+        };
+        return t;
+    }
+    static const double* Keys() {
+        static constexpr double t[] = {
+            0, 0.00390625, 0.0078125, 0.01171875,
+            0.015625, 0.01953125, 0.0234375, 0.02734375,
+            0.03125, 0.03515625, 0.0390625, 0.04296875,
+            0.046875, 0.05078125, 0.0546875, 0.05859375,
+            0.0625, 0.06640625, 0.0703125, 0.07421875,
+            0.078125, 0.08203125, 0.0859375, 0.08984375,
+            0.09375, 0.09765625, 0.1015625, 0.10546875,
+            0.109375, 0.11328125, 0.1171875, 0.12109375,
+            0.125, 0.12890625, 0.1328125, 0.13671875,
+            0.140625, 0.14453125, 0.1484375, 0.15234375,
+            0.15625, 0.16015625, 0.1640625, 0.16796875,
+            0.171875, 0.17578125, 0.1796875, 0.18359375,
+            0.1875, 0.19140625, 0.1953125, 0.19921875,
+            0.203125, 0.20703125, 0.2109375, 0.21484375,
+            0.21875, 0.22265625, 0.2265625, 0.23046875,
+            0.234375, 0.23828125, 0.2421875, 0.24609375,
+            0.25, 0.25390625, 0.2578125, 0.26171875,
+            0.265625, 0.26953125, 0.2734375, 0.27734375,
+            0.28125, 0.28515625, 0.2890625, 0.29296875,
+            0.296875, 0.30078125, 0.3046875, 0.30859375,
+            0.3125, 0.31640625, 0.3203125, 0.32421875,
+            0.328125, 0.33203125, 0.3359375, 0.33984375,
+            0.34375, 0.34765625, 0.3515625, 0.35546875,
+            0.359375, 0.36328125, 0.3671875, 0.37109375,
+            0.375, 0.37890625, 0.3828125, 0.38671875,
+            0.390625, 0.39453125, 0.3984375, 0.40234375,
+            0.40625, 0.41015625, 0.4140625, 0.41796875,
+            0.421875, 0.42578125, 0.4296875, 0.43359375,
+            0.4375, 0.44140625, 0.4453125, 0.44921875,
+            0.453125, 0.45703125, 0.4609375, 0.46484375,
+            0.46875, 0.47265625, 0.4765625, 0.48046875,
+            0.484375, 0.48828125, 0.4921875, 0.49609375,
+            0.5, 0.50390625, 0.5078125, 0.51171875,
+            0.515625, 0.51953125, 0.5234375, 0.52734375,
+            0.53125, 0.53515625, 0.5390625, 0.54296875,
+            0.546875, 0.55078125, 0.5546875, 0.55859375,
+            0.5625, 0.56640625, 0.5703125, 0.57421875,
+            0.578125, 0.58203125, 0.5859375, 0.58984375,
+            0.59375, 0.59765625, 0.6015625, 0.60546875,
+            0.609375, 0.61328125, 0.6171875, 0.62109375,
+            0.625, 0.62890625, 0.6328125, 0.63671875,
+            0.640625, 0.64453125, 0.6484375, 0.65234375,
+            0.65625, 0.66015625, 0.6640625, 0.66796875,
+            0.671875, 0.67578125, 0.6796875, 0.68359375,
+            0.6875, 0.69140625, 0.6953125, 0.69921875,
+            0.703125, 0.70703125, 0.7109375, 0.71484375,
+            0.71875, 0.72265625, 0.7265625, 0.73046875,
+            0.734375, 0.73828125, 0.7421875, 0.74609375,
+            0.75, 0.75390625, 0.7578125, 0.76171875,
+            0.765625, 0.76953125, 0.7734375, 0.77734375,
+            0.78125, 0.78515625, 0.7890625, 0.79296875,
+            0.796875, 0.80078125, 0.8046875, 0.80859375,
+            0.8125, 0.81640625, 0.8203125, 0.82421875,
+            0.828125, 0.83203125, 0.8359375, 0.83984375,
+            0.84375, 0.84765625, 0.8515625, 0.85546875,
+            0.859375, 0.86328125, 0.8671875, 0.87109375,
+            0.875, 0.87890625, 0.8828125, 0.88671875,
+            0.890625, 0.89453125, 0.8984375, 0.90234375,
+            0.90625, 0.91015625, 0.9140625, 0.91796875,
+            0.921875, 0.92578125, 0.9296875, 0.93359375,
+            0.9375, 0.94140625, 0.9453125, 0.94921875,
+            0.953125, 0.95703125, 0.9609375, 0.96484375,
+            0.96875, 0.97265625, 0.9765625, 0.98046875,
+            0.984375, 0.98828125, 0.9921875, 0.99609375,
+            1
+        };
+        return t;
+    }
+};
+
+//------------------------------------------------------------------------------
+///maps/blue-dark-orange-18-steps
+struct BlueDarkOrange18 {
+    enum {SIZE = 19, HSV = 0};
+    static const char* Id() { return "BlueDarkOrange18"; }
+    static const double* Colors() {
+        static constexpr double t[] = {
+            0, 0.40000000000000002, 0.40000000000000002,
+            0, 0.59999999999999998, 0.59999999999999998,
+            0, 0.80000000000000004, 0.80000000000000004,
+            0, 1, 1,
+            0.20000000000000001, 1, 1,
+            0.40000000000000002, 1, 1,
+            0.59999999999999998, 1, 1,
+            0.69999999999999996, 1, 1,
+            0.80000000000000004, 1, 1,
+            0.90000000000000002, 1, 1,
+            1, 0.90000000000000002, 0.80000000000000004,
+            1, 0.79300000000000004, 0.59999999999999998,
+            1, 0.68000000000000005, 0.40000000000000002,
+            1, 0.56000000000000005, 0.20000000000000001,
+            1, 0.433, 0,
+            0.80000000000000004, 0.33300000000000002, 0,
+            0.59999999999999998, 0.23999999999999999, 0,
+            0.40000000000000002, 0.153, 0,
+            0.40000000000000002, 0.153, 0
+        };
+        return t;
+    }
+    static const double* Keys() {
+        static constexpr double t[] = {
+            0, 0.055555555555555552, 0.1111111111111111, 0.16666666666666666,
+            0.22222222222222221, 0.27777777777777779, 0.33333333333333331, 0.3888888888888889,
+            0.44444444444444442, 0.5, 0.55555555555555558, 0.61111111111111116,
+            0.66666666666666663, 0.72222222222222221, 0.77777777777777779, 0.83333333333333337,
+            0.88888888888888884, 0.94444444444444442, 1
+        };
+        return t;
+    }
+};
+
+//------------------------------------------------------------------------------
+///maps/blue-to-dark-orange-18-steps-HSV, HSV
+struct BlueToDarkOrange18HSV {
+    enum {SIZE = 19, HSV = 1};
+    static const char* Id() { return "BlueToDarkOrange18HSV"; }
+    static const double* Colors() {
+        static constexpr double t[] = {
+            80, 1, 0.40000000000000002,
+            80, 1, 0.59999999999999998,
+            80, 1, 0.80000000000000004,
+            80, 1, 1,
+            80, 0.80000000000000004, 1,
+            80, 0.59999999999999998, 1,
+            80, 0.40000000000000002, 1,
+            80, 0.29999999999999999, 1,
+            80, 0.20000000000000001, 1,
+            80, 0.10000000000000001, 1,
+            30, 0.20000000000000001, 1,
+            29, 0.40000000000000002, 1,
+            28, 0.59999999999999998, 1,
+            27, 0.80000000000000004, 1,
+            26, 1, 1,
+            25, 1, 0.80000000000000004,
+            24, 1, 0.59999999999999998,
+            23, 1, 0.40000000000000002,
+            23, 1, 0.40000000000000002
+        };
+        return t;
+    }
+    static const double* Keys() {
+        static constexpr double t[] = {
+            0, 0.055555555555555552, 0.1111111111111111, 0.16666666666666666,
+            0.22222222222222221, 0.27777777777777779, 0.33333333333333331, 0.3888888888888889,
+            0.44444444444444442, 0.5, 0.55555555555555558, 0.61111111111111116,
+            0.66666666666666663, 0.72222222222222221, 0.77777777777777779, 0.83333333333333337,
+            0.88888888888888884, 0.94444444444444442, 1
+        };
+        return t;
+    }
+};
+
+//------------------------------------------------------------------------------
+///maps/dark-red-to-blue-18-steps
+struct DarkRedToBlue18 {
+    enum {SIZE = 19, HSV = 0};
+    static const char* Id() { return "DarkRedToBlue18"; }
+    static const double* Colors() {
+        static constexpr double t[] = {
+            0.14199999999999999, 0, 0.84999999999999998,
+            0.097000000000000003, 0.112, 0.96999999999999997,
+            0.16, 0.34200000000000003, 1,
+            0.23999999999999999, 0.53100000000000003, 1,
+            0.34000000000000002, 0.69199999999999995, 1,
+            0.46000000000000002, 0.82899999999999996, 1,
+            0.59999999999999998, 0.92000000000000004, 1,
+            0.73999999999999999, 0.97799999999999998, 1,
+            0.92000000000000004, 1, 1,
+            1, 1, 0.92000000000000004,
+            1, 0.94799999999999995, 0.73999999999999999,
+            1, 0.83999999999999997, 0.59999999999999998,
+            1, 0.67600000000000005, 0.46000000000000002,
+            1, 0.47199999999999998, 0.34000000000000002,
+            1, 0.23999999999999999, 0.23999999999999999,
+            0.96999999999999997, 0.155, 0.20999999999999999,
+            0.84999999999999998, 0.085000000000000006, 0.187,
+            0.65000000000000002, 0, 0.13,
+            0.65000000000000002, 0, 0.13
+        };
+        return t;
+    }
+    static const double* Keys() {
+        static constexpr double t[] = {
+            0, 0.055555555555555552, 0.1111111111111111, 0.16666666666666666,
+            0.22222222222222221, 0.27777777777777779, 0.33333333333333331, 0.3888888888888889,
+            0.44444444444444442, 0.5, 0.55555555555555558, 0.61111111111111116,
+            0.66666666666666663, 0.72222222222222221, 0.77777777777777779, 0.83333333333333337,
+            0.88888888888888884, 0.94444444444444442, 1
+        };
+        return t;
+    }
+};
+
+//------------------------------------------------------------------------------
+///maps/green-blue-copper-steel4-steps-HSV, HSV
+struct GreenBlueCopperSteel4HSV {
+    enum {SIZE = 4, HSV = 1};
+    static const char* Id() { return "GreenBlueCopperSteel4HSV"; }
+    static const double* Colors() {
+        static constexpr double t[] = {
+            150, 0.40000000000000002, 0.20000000000000001,
+            220, 0.40000000000000002, 0.5,
+            300, 0.69999999999999996, 0.29999999999999999,
+            360, 0.40000000000000002, 1
+        };
+        return t;
+    }
+    static const double* Keys() {
+        static constexpr double t[] = {
+            0, 0.33333333333333331, 0.66666666666666663, 1
+        };
+        return t;
+    }
+};
+
+//------------------------------------------------------------------------------
+///maps/green-to-magenta-16-steps
+struct GreenToMagenta16 {
+    enum {SIZE = 17, HSV = 0};
+    static const char* Id() { return "GreenToMagenta16"; }
+    static const double* Colors() {
+        static constexpr double t[] = {
+            0, 0.316, 0,
+            0, 0.52600000000000002, 0,
+            0, 0.73699999999999999, 0,
+            0, 0.94699999999999995, 0,
+            0.316, 1, 0.316,
+            0.52600000000000002, 1, 0.52600000000000002,
+            0.73699999999999999, 1, 0.73699999999999999,
+            1, 1, 1,
+            1, 0.94699999999999995, 1,
+            1, 0.73699999999999999, 1,
+            1, 0.52600000000000002, 1,
+            1, 0.316, 1,
+            0.94699999999999995, 0, 0.94699999999999995,
+            0.73699999999999999, 0, 0.73699999999999999,
+            0.52600000000000002, 0, 0.52600000000000002,
+            0.316, 0, 0.316,
+            0.316, 0, 0.316
+        };
+        return t;
+    }
+    static const double* Keys() {
+        static constexpr double t[] = {
+            0, 0.0625, 0.125, 0.1875,
+            0.25, 0.3125, 0.375, 0.4375,
+            0.5, 0.5625, 0.625, 0.6875,
+            0.75, 0.8125, 0.875, 0.9375,
+            1
+        };
+        return t;
+    }
+};
+
+//------------------------------------------------------------------------------
+///maps/green-to-magenta-16-steps-HSV, HSV
+struct GreenToMagenta16HSV {
+    enum {SIZE = 17, HSV = 1};
+    static const char* Id() { return "GreenToMagenta16HSV"; }
+    static const double* Colors() {
+        static constexpr double t[] = {
+            120, 1, 0.316,
+            120, 1, 0.52600000000000002,
+            120, 1, 0.73699999999999999,
+            120, 1, 0.94699999999999995,
+            120, 0.68400000000000005, 1,
+            120, 0.47399999999999998, 1,
+            120, 0.26300000000000001, 1,
+            0, 0, 1,
+            300, 0.052999999999999999, 1,
+            300, 0.26300000000000001, 1,
+            300, 0.47399999999999998, 1,
+            300, 0.68400000000000005, 1,
+            300, 1, 0.94699999999999995,
+            300, 1, 0.73699999999999999,
+            300, 1, 0.52600000000000002,
+            300, 1, 0.316,
+            300, 1, 0.316
+        };
+        return t;
+    }
+    static const double* Keys() {
+        static constexpr double t[] = {
+            0, 0.0625, 0.125, 0.1875,
+            0.25, 0.3125, 0.375, 0.4375,
+            0.5, 0.5625, 0.625, 0.6875,
+            0.75, 0.8125, 0.875, 0.9375,
+            1
+        };
+        return t;
+    }
+};
+
+//------------------------------------------------------------------------------
+///maps/step-sequences-25-steps
+struct StepSequences25 {
+    enum {SIZE = 26, HSV = 0};
+    static const char* Id() { return "StepSequences25"; }
+    static const double* Colors() {
+        static constexpr double t[] = {
+            0.59999999999999998, 0.059999999999999998, 0.059999999999999998,
+            0.69999999999999996, 0.17499999999999999, 0.17499999999999999,
+            0.80000000000000004, 0.32000000000000001, 0.32000000000000001,
+            0.90000000000000002, 0.495, 0.495,
+            1, 0.69999999999999996, 0.69999999999999996,
+            0.59999999999999998, 0.33000000000000002, 0.059999999999999998,
+            0.69999999999999996, 0.438, 0.17499999999999999,
+            0.80000000000000004, 0.56000000000000005, 0.32000000000000001,
+            0.90000000000000002, 0.69699999999999995, 0.495,
+            1, 0.84999999999999998, 0.69999999999999996,
+            0.41999999999999998, 0.59999999999999998, 0.059999999999999998,
+            0.52500000000000002, 0.69999999999999996, 0.17499999999999999,
+            0.64000000000000001, 0.80000000000000004, 0.32000000000000001,
+            0.76500000000000001, 0.90000000000000002, 0.495,
+            0.90000000000000002, 1, 0.69999999999999996,
+            0.059999999999999998, 0.41999999999999998, 0.59999999999999998,
+            0.17499999999999999, 0.52500000000000002, 0.69999999999999996,
+            0.32000000000000001, 0.64000000000000001, 0.80000000000000004,
+            0.495, 0.76500000000000001, 0.90000000000000002,
+            0.69999999999999996, 0.90000000000000002, 1,
+            0.14999999999999999, 0.059999999999999998, 0.59999999999999998,
+            0.26200000000000001, 0.17499999999999999, 0.69999999999999996,
+            0.40000000000000002, 0.32000000000000001, 0.80000000000000004,
+            0.56200000000000006, 0.495, 0.90000000000000002,
+            0.75, 0.69999999999999996, 1,
+            0.75, 0.69999999999999996, 1
+        };
+        return t;
+    }
+    static const double* Keys() {
+        static constexpr double t[] = {
+            0, 0.040000000000000001, 0.080000000000000002, 0.12,
+            0.16, 0.20000000000000001, 0.23999999999999999, 0.28000000000000003,
+            0.32000000000000001, 0.35999999999999999, 0.40000000000000002, 0.44,
+            0.47999999999999998, 0.52000000000000002, 0.56000000000000005, 0.59999999999999998,
+            0.64000000000000001, 0.68000000000000005, 0.71999999999999997, 0.76000000000000001,
+            0.80000000000000004, 0.83999999999999997, 0.88, 0.92000000000000004,
+            0.95999999999999996, 1
+        };
+        return t;
+    }
+};
+
+} //namespace builtin
+
+//------------------------------------------------------------------------------
+///All the built-in colormaps
+inline const std::vector< BuiltinColormap >& BuiltinColormaps() {
+    static const std::vector< BuiltinColormap > maps = {
+        MakeBuiltinColormap< builtin::Default >(),
+        MakeBuiltinColormap< builtin::CoolWarmFloat5 >(),
+        MakeBuiltinColormap< builtin::CoolWarmFloat10 >(),
+        MakeBuiltinColormap< builtin::CoolWarmFloat33 >(),
+        MakeBuiltinColormap< builtin::CoolWarmFloat257 >(),
+        MakeBuiltinColormap< builtin::CoolWarmUChar33 >(),
+        MakeBuiltinColormap< builtin::CoolWarmUChar257 >(),
+        MakeBuiltinColormap< builtin::BlueDarkOrange18 >(),
+        MakeBuiltinColormap< builtin::BlueToDarkOrange18HSV >(),
+        MakeBuiltinColormap< builtin::DarkRedToBlue18 >(),
+        MakeBuiltinColormap< builtin::GreenBlueCopperSteel4HSV >(),
+        MakeBuiltinColormap< builtin::GreenToMagenta16 >(),
+        MakeBuiltinColormap< builtin::GreenToMagenta16HSV >(),
+        MakeBuiltinColormap< builtin::StepSequences25 >()
+    };
+    return maps;
+}
+
+///Built-in colormap @c name, nullptr if not found
+inline const BuiltinColormap* FindBuiltinColormap(const std::string& name) {
+    for(const BuiltinColormap& m: BuiltinColormaps())
+        if(name == m.name) return &m;
+    return nullptr;
+}
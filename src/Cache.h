@@ -0,0 +1,98 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <utility>
+
+//------------------------------------------------------------------------------
+///Immutable objects built once per key and shared, e.g. the parsed colormaps
+///and lookup tables of a long running process. Thread safe; objects are
+///built outside of the lock, if two threads build the same key the first
+///one stored is kept. The cache is emptied when it holds @c capacity
+///objects.
+template < typename T >
+class SharedCache {
+public:
+    explicit SharedCache(std::size_t capacity = 256) : capacity_(capacity) {}
+    ///Cached object or make() stored under @c key, make returns a T
+    template < typename F >
+    std::shared_ptr< const T > Get(const std::string& key, F make) {
+        {
+            std::lock_guard< std::mutex > lock(mutex_);
+            auto i = cache_.find(key);
+            if(i != cache_.end()) return i->second;
+        }
+        std::shared_ptr< const T > v = std::make_shared< T >(make());
+        std::lock_guard< std::mutex > lock(mutex_);
+        if(cache_.size() >= capacity_) cache_.clear();
+        return cache_.insert(std::make_pair(key, v)).first->second;
+    }
+    std::size_t Size() const {
+        std::lock_guard< std::mutex > lock(mutex_);
+        return cache_.size();
+    }
+private:
+    std::size_t capacity_;
+    std::unordered_map< std::string, std::shared_ptr< const T > > cache_;
+    mutable std::mutex mutex_;
+};
+
+//------------------------------------------------------------------------------
+///Pool of stateful objects with the same configuration per key, e.g. image
+///writers with their encoder handles and buffers: an object is used by one
+///thread at a time through a Lease and returned to the pool when the lease
+///is destroyed. Thread safe.
+template < typename T >
+class KeyedPool {
+public:
+    class Lease {
+    public:
+        Lease(KeyedPool* pool, const std::string& key, std::unique_ptr< T > p)
+            : pool_(pool), key_(key), p_(std::move(p)) {}
+        Lease(Lease&&) = default;
+        ///The object held is returned to its pool first
+        Lease& operator=(Lease&& other) {
+            if(this == &other) return *this;
+            if(pool_ && p_) pool_->Put(key_, std::move(p_));
+            pool_ = other.pool_;
+            key_ = std::move(other.key_);
+            p_ = std::move(other.p_);
+            return *this;
+        }
+        ~Lease() { if(pool_ && p_) pool_->Put(key_, std::move(p_)); }
+        T& operator*() const { return *p_; }
+        T* operator->() const { return p_.get(); }
+    private:
+        KeyedPool* pool_;
+        std::string key_;
+        std::unique_ptr< T > p_;
+    };
+    ///Pooled object or make() if none is available, make returns a
+    ///std::unique_ptr< T >
+    template < typename F >
+    Lease Get(const std::string& key, F make) {
+        std::unique_ptr< T > p;
+        {
+            std::lock_guard< std::mutex > lock(mutex_);
+            auto i = free_.find(key);
+            if(i != free_.end() && !i->second.empty()) {
+                p = std::move(i->second.back());
+                i->second.pop_back();
+            }
+        }
+        if(!p) p = make();
+        return Lease(this, key, std::move(p));
+    }
+private:
+    void Put(const std::string& key, std::unique_ptr< T > p) {
+        std::lock_guard< std::mutex > lock(mutex_);
+        free_[key].push_back(std::move(p));
+    }
+private:
+    std::unordered_map< std::string,
+                        std::vector< std::unique_ptr< T > > > free_;
+    std::mutex mutex_;
+};
@@ -6,6 +6,7 @@
 #include <tuple>
 #include <cmath>
 #include <cassert>
+#include <limits>
 
 
 #include "Vector3D.h"
@@ -126,6 +127,11 @@ KeyFramedCRomInterpolation(const std::vector< Vector3D< ScalarT > >& points,
     assert(points.size());
     assert(keys.size());
     assert(points.size() == keys.size());
+    assert(maxVal >= minVal);
+    t = maxVal > minVal ? (t - minVal) / (maxVal - minVal) : ScalarT(0);
+    //clamp to the keyframe range: values outside map to the end points
+    if(!(t > keys.front())) t = keys.front();
+    if(t > keys.back()) t = keys.back();
     using K = std::vector< ScalarT >;
     typename K::const_iterator i = 
                                   std::lower_bound(keys.begin(), keys.end(), t);
@@ -134,25 +140,136 @@ KeyFramedCRomInterpolation(const std::vector< Vector3D< ScalarT > >& points,
     if(t < *i) --i;                        
     typename K::const_iterator j = i;
     ++j;
-    const ScalarT u = j == keys.end() ? ScalarT(0) : (t - *i) / (*j - *i);
+    if(j == keys.end()) return points.back();
+    const ScalarT u = (t - *i) / (*j - *i);
     using V = Vector3D< double >;
     const std::size_t pidx1 = std::size_t(std::distance(keys.begin(), i));
-    const std::size_t pidx0 = std::max(pidx1 - 1, std::size_t(0));
     const std::size_t pidx2 = pidx1 + 1;
     const std::size_t pidx3 = std::min(points.size() - 1, pidx2 + 1);
-    //const V& p0 = points[pidx0];
     const V& p1 = points[pidx1];
     const V& p2 = points[pidx2];
-    //const V& p3 = points[pidx3];
     V p0;
     V p3;
-    if(pidx1 - 1 < 0) {
+    if(pidx1 == 0) {
         p0 = ScalarT(2) * p1 - p2;
-    } else p0 = points[pidx0];
+    } else p0 = points[pidx1 - 1];
     if(pidx2 + 1 >= points.size()) {
         p3 = ScalarT(2) * p2 - p1;
     } else p3 = points[pidx3];
-    return CatmullRom(u, p0, p1, p2, p3, minVal, maxVal);
+    return CatmullRom(u, p0, p1, p2, p3);
 }
 
+//------------------------------------------------------------------------------
+///KeyFramedCRomInterpolation compiled once per colormap: the polynomial
+///coefficients of each segment are stored in SoA form and the segment of a
+///parameter is found without a search, directly from the parameter for evenly
+///spaced keys or through a uniform grid of cells mapped to the first segment
+///overlapping each cell otherwise. The cell index is then corrected against
+///the keys, at most one step in practice, so that the segment is the same as
+///the one found by std::lower_bound. Same results as
+///KeyFramedCRomInterpolation, bit for bit: same coefficients, same
+///evaluation order and same divisions.
+template < typename ScalarT >
+class CompiledSpline {
+public:
+    ///@c points and @c keys as in KeyFramedCRomInterpolation, keys sorted
+    CompiledSpline(const std::vector< Vector3D< ScalarT > >& points,
+                   const std::vector< ScalarT >& keys)
+        : keys_(keys), last_(points.empty() ? Vector3D< ScalarT >()
+                                            : points.back()) {
+        assert(points.size());
+        assert(points.size() == keys.size());
+        nseg_ = keys.size() - 1;
+        coeff_.resize(12 * nseg_);
+        ScalarT minWidth = std::numeric_limits< ScalarT >::max();
+        for(std::size_t s = 0; s != nseg_; ++s) {
+            const Vector3D< ScalarT >& P1 = points[s];
+            const Vector3D< ScalarT >& P2 = points[s + 1];
+            const Vector3D< ScalarT > P0 = s == 0 ? ScalarT(2) * P1 - P2
+                                                  : points[s - 1];
+            const Vector3D< ScalarT > P3 = s + 2 < points.size() ?
+                                           points[s + 2]
+                                           : ScalarT(2) * P2 - P1;
+            const Vector3D< ScalarT > c[4] = {
+                P1,
+                -0.5 * P0 + 0.5 * P2,
+                P0 - 2.5 * P1 + 2.0 * P2 - 0.5 * P3,
+                - 0.5 * P0 + 1.5 * P1 - 1.5 * P2 + 0.5 * P3};
+            for(int ch = 0; ch != 3; ++ch)
+                for(int i = 0; i != 4; ++i)
+                    coeff_[(4 * ch + i) * nseg_ + s] = c[i][ch];
+            const ScalarT w = keys[s + 1] - keys[s];
+            if(w > ScalarT(0)) minWidth = std::min(minWidth, w);
+        }
+        if(nseg_ == 0) return;
+        const ScalarT range = keys.back() - keys.front();
+        //evenly spaced keys: one cell per segment, the cell is the segment
+        bool uniform = true;
+        for(std::size_t s = 0; s != keys.size() && uniform; ++s) {
+            const ScalarT k = keys.front() + range * ScalarT(s) / nseg_;
+            uniform = std::abs(keys[s] - k) <= ScalarT(1E-9) * range;
+        }
+        cells_ = nseg_;
+        if(!uniform && range > ScalarT(0)) {
+            //about one key per cell, at most MAX_CELLS_PER_SEGMENT cells per
+            //segment
+            const ScalarT cells = std::ceil(range / minWidth);
+            cells_ = std::max(nseg_, std::size_t(std::min(cells,
+                                         ScalarT(MAX_CELLS_PER_SEGMENT
+                                                 * nseg_))));
+            grid_.resize(cells_);
+            std::size_t s = 0;
+            for(std::size_t c = 0; c != cells_; ++c) {
+                const ScalarT t = keys.front() + range * ScalarT(c) / cells_;
+                while(s + 1 < nseg_ && keys[s + 1] <= t) ++s;
+                grid_[c] = s;
+            }
+        }
+        scale_ = range > ScalarT(0) ? ScalarT(cells_) / range : ScalarT(0);
+    }
+    ///Same as KeyFramedCRomInterpolation(points, keys, t, minVal, maxVal)
+    Vector3D< ScalarT > operator()(ScalarT t,
+                                   ScalarT minVal = ScalarT(0),
+                                   ScalarT maxVal = ScalarT(1)) const {
+        assert(maxVal >= minVal);
+        t = maxVal > minVal ? (t - minVal) / (maxVal - minVal) : ScalarT(0);
+        //clamp to the keyframe range: values outside map to the end points
+        if(!(t > keys_.front())) t = keys_.front();
+        if(!(t < keys_.back())) return last_;
+        const std::size_t s = Segment(t);
+        const ScalarT u = (t - keys_[s]) / (keys_[s + 1] - keys_[s]);
+        const ScalarT* c = &coeff_[s];
+        const std::size_t n = nseg_;
+        return Vector3D< ScalarT >(
+            ((c[3 * n] * u + c[2 * n]) * u + c[n]) * u + c[0],
+            ((c[7 * n] * u + c[6 * n]) * u + c[5 * n]) * u + c[4 * n],
+            ((c[11 * n] * u + c[10 * n]) * u + c[9 * n]) * u + c[8 * n]);
+    }
+    std::size_t Segments() const { return nseg_; }
+    ///true if the segment is computed directly from the parameter
+    bool Uniform() const { return grid_.empty(); }
+private:
+    enum {MAX_CELLS_PER_SEGMENT = 16};
+    ///Segment [keys_[s], keys_[s + 1]) containing t in [first key, last key)
+    std::size_t Segment(ScalarT t) const {
+        const std::size_t c = std::min(std::size_t((t - keys_.front())
+                                                   * scale_), cells_ - 1);
+        std::size_t s = grid_.empty() ? c : grid_[c];
+        //rounding of the cell index
+        while(s > 0 && keys_[s] > t) --s;
+        while(s + 1 < nseg_ && keys_[s + 1] <= t) ++s;
+        return s;
+    }
+private:
+    std::vector< ScalarT > keys_;
+    Vector3D< ScalarT > last_;
+    std::size_t nseg_ = 0;
+    ///c[0] + c[1] u + c[2] u^2 + c[3] u^3: coeff_[(4 * channel + i) * nseg_ + s]
+    std::vector< ScalarT > coeff_;
+    std::size_t cells_ = 1;
+    ScalarT scale_ = ScalarT(0);
+    ///first segment overlapping each cell, empty for evenly spaced keys
+    std::vector< std::size_t > grid_;
+};
+
     
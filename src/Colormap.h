@@ -0,0 +1,261 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <tuple>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+
+#include "io.h"
+#include "CatmullRom.h"
+#include "ColormapLUT.h"
+#include "ColormapKernel.h"
+#include "MinMax.h"
+
+//------------------------------------------------------------------------------
+///Colors, one per line: three values, hexadecimal (0x..) or decimal; with
+///@c autonorm decimal values > 1 are divided by 255
+inline std::vector< Vector3D< double > > ReadColors(std::istream& is,
+                                                    bool autonorm) {
+    std::string buf;
+    std::vector< Vector3D< double > > colors;
+    while(is) {
+        getline(is, buf);
+        if(buf.empty()) continue;
+        std::istringstream iss(buf);
+        if(!iss) throw std::logic_error("Invalid color format");
+        Vector3D< double > color;
+        std::string r;
+        iss >> r;
+        if(!iss) throw std::logic_error("Invalid color format");
+        std::string g;
+        iss >> g;
+        if(!iss) throw std::logic_error("Invalid color format");
+        std::string b;
+        iss >> b;
+        if(r.find("0x") == 0)
+            color[0] = std::stoi(r, nullptr, 16) / 255.0;
+        else {
+            color[0] = std::stod(r);
+            if(autonorm && color[0] > 1.0) color[0] /= 255.0;
+        }
+        if(g.find("0x") == 0)
+            color[1] = std::stoi(g, nullptr, 16) / 255.0;
+        else{
+            color[1] = std::stod(g);
+            if(autonorm && color[1] > 1.0) color[1] /= 255.0;
+        }
+        if(b.find("0x") == 0)
+            color[2] = std::stoi(b, nullptr, 16) / 255.0;
+        else {
+            color[2] = std::stod(b);
+            if(autonorm && color[2] > 1.0) color[2] /= 255.0;
+        }
+        colors.push_back(color);
+    }
+    return colors;
+}
+
+using KeyData = std::tuple< std::vector< Vector3D< double > >,
+                            std::vector< double > >;
+inline KeyData ReadColorsCSV(std::istream& is, double norm) {
+    return Read3DVectorKeyFramesCSV< double >(is, norm);
+}
+
+///Evenly spaced keys or, with @c distance, keys proportional to the
+///distance between colors
+inline std::vector< double >
+ColormapKeys(const std::vector< Vector3D< double > >& colors, bool distance) {
+    if(distance) return ComputeDistances(colors.begin(), colors.end());
+    std::vector< double > keys(colors.size());
+    for(int k = 0; k != keys.size(); ++k) {
+        keys[k] = double(k) / (keys.size() - 1);
+    }
+    return keys;
+}
+
+///Colors and keys of the colormap in @c fname, default colormap if empty;
+///keys are computed by ColormapKeys unless read from a CSV file
+inline KeyData ReadColormap(const std::string& fname, bool csv, double norm,
+                            bool hsv, bool distance) {
+    std::vector< Vector3D< double > > colors;
+    std::vector< double > keys;
+    if(!fname.empty()) {
+        std::ifstream is(fname);
+        if(!is) throw std::runtime_error("Cannot open input file");
+        if(csv) {
+            const KeyData kd = ReadColorsCSV(is, norm);
+            colors = std::get< KEYFRAME::DATA >(kd);
+            keys = std::get< KEYFRAME::KEYS >(kd);
+        } else colors = ReadColors(is, !hsv);
+    } else {
+        std::vector< Vector3D< double > > scolors =
+    //{{1,1,1}, {1, 1, 0}, {0, 1, 1}, {1, 0.5, 0.50}, {0, 0.5, 1}, {0.2, 0.4, 1}};
+        {0xFFFFFF, 0xA3F9FF, 0x0FEFFF, 0x0EE1F0, 0x1FD2FF, 0x00C0F0};
+        colors = scolors;
+    }
+    if(keys.empty()) keys = ColormapKeys(colors, distance);
+    return KeyData(colors, keys);
+}
+
+///Lookup table of @c size entries, linear or Catmull-Rom, RGB or HSV
+inline ColormapLUT MakeLUT(const std::vector< Vector3D< double > >& colors,
+                           const std::vector< double >& keys,
+                           bool cubic, bool hsv, double normFactor,
+                           std::size_t size, bool exactEndpoints) {
+    if(!hsv) {
+        return cubic ? CRKLUT(colors, keys, normFactor, size, exactEndpoints)
+                     : LLUT(colors, keys, normFactor, size, exactEndpoints);
+    }
+    return cubic ? CRKHSVLUT(colors, keys, normFactor, size, exactEndpoints)
+                 : LHSVLUT(colors, keys, normFactor, size, exactEndpoints);
+}
+
+//------------------------------------------------------------------------------
+///Maximum value range of integer data colorized through a table of the
+///colors of each value
+static const long long MAX_INTEGER_TABLE_SIZE = 1 << 20;
+
+///Colorization of values in [minVal, maxVal], shared by cmap and Colormap:
+///integer data with a range below MAX_INTEGER_TABLE_SIZE through a table of
+///the colors of each value computed once, other data through the lookup
+///table or, if @c exact, through the kernel passed to Map
+template < typename T >
+class RangeColorizer {
+public:
+    ///@c table holds the integer table if any, it can be reused across
+    ///ranges
+    RangeColorizer(const ColormapLUT& lut, T minVal, T maxVal, bool exact,
+                   std::vector< ColorType >& table)
+        : lut_(lut), min_(minVal), max_(maxVal), exact_(exact),
+          table_(table) {
+        useTable_ = !exact && std::is_integral< T >::value
+                    && (long long)(maxVal) - (long long)(minVal)
+                       < MAX_INTEGER_TABLE_SIZE;
+        if(useTable_) lut.IntegerTable(minVal, maxVal, table_);
+    }
+    ///Colorize [b, e) into @c out; in exact mode
+    ///kernel(begin, end, out, min, max) colorizes blocks of doubles
+    template < typename KernelT >
+    void Map(const T* b, const T* e, ColorType* out,
+             const KernelT& kernel) const {
+        if(useTable_) {
+            ColormapLUT::MapInteger(b, e, out, table_, min_);
+        } else if(!exact_) {
+            lut_.Map(b, e, out, min_, max_);
+        } else {
+            AsDouble(b, e, out, [&](const double* db, const double* de,
+                                    ColorType* o) {
+                kernel(db, de, o, double(min_), double(max_));
+            });
+        }
+    }
+private:
+    const ColormapLUT& lut_;
+    T min_;
+    T max_;
+    bool exact_;
+    std::vector< ColorType >& table_;
+    bool useTable_;
+};
+
+//------------------------------------------------------------------------------
+///Colormap options, same as the cmap command line ones
+struct ColormapOptions {
+    ///Catmull-Rom interpolation, default is linear
+    bool cubic = false;
+    ///colors are HSV
+    bool hsv = false;
+    ///evaluate the colormap at each value instead of using a lookup table
+    bool exact = false;
+    std::size_t lutSize = ColormapLUT::DEFAULT_SIZE;
+    bool lutEnds = false;
+};
+
+///Colormap ready to colorize data from memory: the embeddable counterpart of
+///the cmap command line. Built once, then Colorize can be called from any
+///number of threads.
+class Colormap {
+public:
+    using Options = ColormapOptions;
+    ///@c colors in [0, 1], @c keys in [0, 1] and sorted, evenly spaced if
+    ///empty
+    Colormap(const std::vector< Vector3D< double > >& colors,
+             const std::vector< double >& keys = std::vector< double >(),
+             const Options& options = Options())
+        : colors_(colors),
+          keys_(keys.empty() ? ColormapKeys(colors, false) : keys),
+          options_(options),
+          kernel_(colors_, keys_,
+                  options.cubic ? ColormapKernel::CATMULL_ROM
+                                : ColormapKernel::LINEAR,
+                  NormFactor(),
+                  options.hsv ? ColormapKernel::HSV : ColormapKernel::RGB) {
+        if(colors_.size() < 2 || colors_.size() != keys_.size())
+            throw std::logic_error("Invalid colormap");
+        if(!options.exact) {
+            lut_ = MakeLUT(colors_, keys_, options.cubic, options.hsv,
+                           NormFactor(), options.lutSize, options.lutEnds);
+        }
+    }
+    ///Colormap file as read by cmap -f, with -csv if @c csv
+    static Colormap Load(const std::string& fname, bool csv = false,
+                         const Options& options = Options()) {
+        const KeyData kd = ReadColormap(fname, csv, 1.0, options.hsv, false);
+        return Colormap(std::get< KEYFRAME::DATA >(kd),
+                        std::get< KEYFRAME::KEYS >(kd), options);
+    }
+    ///Colorize the @c n values of @c data into @c rgb, which must hold
+    ///3 * n elements; [minVal, maxVal] is mapped to the colormap
+    template < typename T >
+    void Colorize(const T* data, std::size_t n, ColorType* rgb,
+                  T minVal, T maxVal, int threads = 1) const {
+        if(maxVal < minVal) throw std::logic_error("Invalid range");
+        std::vector< ColorType > table;
+        const RangeColorizer< T > colorizer(lut_, minVal, maxVal,
+                                            options_.exact, table);
+        ParallelFor(n, 1 << 16, threads, [&](std::size_t b, std::size_t e) {
+            colorizer.Map(data + b, data + e, rgb + 3 * b,
+                          [this](const double* db, const double* de,
+                                 ColorType* o, double mn, double mx) {
+                kernel_.Map(db, de, o, mn, mx);
+            });
+        });
+    }
+    ///Colorize with the range of the data, NaNs left out, and infinities
+    ///too if @c finite as with cmap -finite; returns false if there is no
+    ///valid value
+    template < typename T >
+    bool Colorize(const T* data, std::size_t n, ColorType* rgb,
+                  int threads = 1, bool finite = false) const {
+        const ScalarRange< T > r = MinMax(data, data + n, threads, finite);
+        if(!r.count) return false;
+        Colorize(data, n, rgb, r.min, r.max, threads);
+        return true;
+    }
+    template < typename T >
+    std::vector< ColorType > Colorize(const std::vector< T >& data,
+                                      T minVal, T maxVal,
+                                      int threads = 1) const {
+        std::vector< ColorType > rgb(3 * data.size());
+        Colorize(data.data(), data.size(), rgb.data(), minVal, maxVal,
+                 threads);
+        return rgb;
+    }
+    const std::vector< Vector3D< double > >& Colors() const { return colors_; }
+    const std::vector< double >& Keys() const { return keys_; }
+    const Options& GetOptions() const { return options_; }
+    ///empty with Options::exact
+    const ColormapLUT& LUT() const { return lut_; }
+    const ColormapKernel& Kernel() const { return kernel_; }
+private:
+    ///colors in [0, 1] scaled to [0, 255]
+    static double NormFactor() { return 255.0; }
+    std::vector< Vector3D< double > > colors_;
+    std::vector< double > keys_;
+    Options options_;
+    ColormapLUT lut_;
+    ColormapKernel kernel_;
+};
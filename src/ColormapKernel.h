@@ -0,0 +1,451 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstring>
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+
+#include "Vector3D.h"
+#include "io.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SCOLOR_X86_SIMD
+//GCC 12 -Wmaybe-uninitialized false positives, see MinMax.h
+#ifndef __clang__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+#ifndef __clang__
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+//------------------------------------------------------------------------------
+///Batch evaluation of linear and Catmull-Rom keyframed colormaps.
+///Same results as LinearInterpolation and KeyFramedCRomInterpolation
+///(up to rounding), but the per-segment polynomial coefficients are computed
+///once and stored in SoA form, the segment is found through a branchless
+///binary search and the colors are saturated to [0, 255] before the
+///conversion to ColorType.
+///Map selects at run-time the widest instruction set supported by the CPU:
+///AVX-512, AVX2 or portable scalar code; all paths give identical results.
+///HSV colormaps are interpolated in HSV space and converted to RGB in the
+///same batch through a branchless hsv2rgb: the hue sector selects p, q, t
+///or v with blends instead of a switch, results identical to hsv2rgb.
+class ColormapKernel {
+public:
+    enum Interpolation {LINEAR, CATMULL_ROM};
+    enum ColorSpace {RGB, HSV};
+    enum ISA {SCALAR, AVX2, AVX512};
+    ColormapKernel(const std::vector< Vector3D< double > >& colors,
+                   const std::vector< double >& keys,
+                   Interpolation interpolation,
+                   double scalingFactor = 1.0,
+                   ColorSpace colorSpace = RGB)
+        : hsv_(colorSpace == HSV), scale_(scalingFactor) {
+        if(colors.empty() || colors.size() != keys.size())
+            throw std::logic_error("Invalid colormap");
+        std::vector< Vector3D< double > > p(colors);
+        std::vector< double > k(keys);
+        if(p.size() == 1) {
+            p.push_back(p.back());
+            k.push_back(k.back() + 1.0);
+        }
+        const std::size_t n = p.size();
+        nseg_ = n - 1;
+        levels_ = 0;
+        while((std::size_t(1) << levels_) < nseg_) ++levels_;
+        //interior keys padded with +inf to 2^levels - 1 elements
+        search_.assign((std::size_t(1) << levels_) - 1,
+                       std::numeric_limits< double >::infinity());
+        std::copy(k.begin() + 1, k.end() - 1, search_.begin());
+        first_ = k.front();
+        last_ = k.back();
+        key_.assign(k.begin(), k.end() - 1);
+        invWidth_.resize(nseg_);
+        coeff_.resize(12 * nseg_);
+        for(std::size_t s = 0; s != nseg_; ++s) {
+            const double w = k[s + 1] - k[s];
+            invWidth_[s] = w > 0.0 ? 1.0 / w : 0.0;
+            Vector3D< double > c[4];
+            SegmentCoefficients(p.data(), n, s, interpolation, c);
+            //HSV colors are scaled after the conversion to RGB
+            const double f = hsv_ ? 1.0 : scalingFactor;
+            for(int ch = 0; ch != 3; ++ch)
+                for(int i = 0; i != 4; ++i)
+                    coeff_[(4 * ch + i) * nseg_ + s] = f * c[i][ch];
+        }
+    }
+    ///Coefficients c[0] + c[1] u + c[2] u^2 + c[3] u^3, u in [0, 1], of
+    ///segment [p[s], p[s + 1]] of the @c n colors @c p, n >= 2; the end
+    ///segments of Catmull-Rom splines use reflected end points
+    static void SegmentCoefficients(const Vector3D< double >* p, std::size_t n,
+                                    std::size_t s, Interpolation interpolation,
+                                    Vector3D< double >* c) {
+        const Vector3D< double >& P1 = p[s];
+        const Vector3D< double >& P2 = p[s + 1];
+        if(interpolation == CATMULL_ROM) {
+            const Vector3D< double > P0 = s == 0 ? 2.0 * P1 - P2
+                                                 : p[s - 1];
+            const Vector3D< double > P3 = s + 2 < n ? p[s + 2]
+                                                    : 2.0 * P2 - P1;
+            c[0] = P1;
+            c[1] = -0.5 * P0 + 0.5 * P2;
+            c[2] = P0 - 2.5 * P1 + 2.0 * P2 - 0.5 * P3;
+            c[3] = - 0.5 * P0 + 1.5 * P1 - 1.5 * P2 + 0.5 * P3;
+        } else {
+            c[0] = P1;
+            c[1] = P2 - P1;
+            c[2] = Vector3D< double >();
+            c[3] = Vector3D< double >();
+        }
+    }
+    ///Widest instruction set supported by the CPU
+    static ISA DetectISA() {
+#ifdef SCOLOR_X86_SIMD
+        static const ISA isa = __builtin_cpu_supports("avx512f") ? AVX512
+                             : __builtin_cpu_supports("avx2") ? AVX2
+                             : SCALAR;
+        return isa;
+#else
+        return SCALAR;
+#endif
+    }
+    static const char* ISAName(ISA isa) {
+        return isa == AVX512 ? "avx512" : isa == AVX2 ? "avx2" : "scalar";
+    }
+    ///Colorize [begin, end) into out, which must hold 3 * (end - begin)
+    ///elements; [minVal, maxVal] is mapped to [0, 1]
+    void Map(const double* begin, const double* end, ColorType* out,
+             double minVal, double maxVal) const {
+        Map(begin, end, out, minVal, maxVal, DetectISA());
+    }
+    ///Colorize with a specific instruction set, which must be supported
+    void Map(const double* begin, const double* end, ColorType* out,
+             double minVal, double maxVal, ISA isa) const {
+        assert(maxVal >= minVal);
+        const double invRange = maxVal > minVal ? 1.0 / (maxVal - minVal)
+                                                : 0.0;
+        const std::size_t n = std::size_t(end - begin);
+        std::size_t done = 0;
+#ifdef SCOLOR_X86_SIMD
+        if(isa == AVX512) done = MapAVX512(begin, n, out, minVal, invRange);
+        else if(isa == AVX2) done = MapAVX2(begin, n, out, minVal, invRange);
+#endif
+        MapScalar(begin + done, n - done, out + 3 * done, minVal, invRange);
+    }
+    ///Color channel value clamped to [0, 255]
+    static ColorType Saturate(double v) {
+        return v > 255.0 ? ColorType(255)
+                         : v > 0.0 ? ColorType(v) : ColorType(0);
+    }
+    ///Same as hsv2rgb followed by a multiplication by scale, in place;
+    ///the hue sector indexes a table of the r, g, b permutations of
+    ///v, p, q and t
+    static void HSVToRGB(double* c, double scale) {
+        enum {V, P, Q, T};
+        //sectors 0 to 5, then achromatic case
+        static const unsigned char select[7][3] = {
+            {V, T, P}, {Q, V, P}, {P, V, T}, {P, Q, V}, {T, P, V}, {V, P, Q},
+            {V, V, V}};
+        const double h = c[0];
+        const double s = c[1];
+        const double v = c[2];
+        const double hh = (h >= 360.0 ? 0.0 : h) / 60.0;
+        //out of range values and NaNs select the last sector, as the
+        //default case of hsv2rgb
+        const long i = hh == hh && hh > -1.0 ? long(hh) : 5;
+        const double f = hh - double(i);
+        const double x[4] = {v,
+                             v * (1.0 - s),
+                             v * (1.0 - (s * f)),
+                             v * (1.0 - (s * (1.0 - f)))};
+        const unsigned char* sel = select[s <= 0.0 ? 6 : i];
+        c[0] = scale * x[sel[0]];
+        c[1] = scale * x[sel[1]];
+        c[2] = scale * x[sel[2]];
+    }
+    ///Maximum number of segments searched through a linear scan of the keys
+    ///in the SIMD paths, the AVX-512 path uses a binary search with gathers
+    ///above this size
+    enum {LINEAR_SEARCH_SIZE = 32};
+#ifdef SCOLOR_X86_SIMD
+    ///Store 4 r, g, b int32 values as 12 interleaved bytes, saturating
+    __attribute__((target("avx2")))
+    static void Store4RGB(__m128i r, __m128i g, __m128i b, ColorType* out) {
+        const __m128i rg = _mm_packus_epi32(r, g);
+        const __m128i b0 = _mm_packus_epi32(b, _mm_setzero_si128());
+        const __m128i planar = _mm_packus_epi16(rg, b0);
+        const __m128i interleave = _mm_setr_epi8(0, 4, 8, 1, 5, 9, 2, 6,
+                                                 10, 3, 7, 11,
+                                                 -1, -1, -1, -1);
+        ColorType tmp[16];
+        _mm_storeu_si128(reinterpret_cast< __m128i* >(tmp),
+                         _mm_shuffle_epi8(planar, interleave));
+        std::memcpy(out, tmp, 12);
+    }
+    ///Four element gather through scalar loads, faster than vgatherdpd on
+    ///CPUs where gathers are microcoded
+    __attribute__((target("avx2")))
+    static __m256d Gather4(const double* base, const int* idx) {
+        return _mm256_setr_pd(base[idx[0]], base[idx[1]],
+                              base[idx[2]], base[idx[3]]);
+    }
+    ///Four lane HSVToRGB
+    __attribute__((target("avx2")))
+    static void HSVToRGB(__m256d* c, double scale) {
+        const __m256d h = c[0];
+        const __m256d s = c[1];
+        const __m256d v = c[2];
+        const __m256d one = _mm256_set1_pd(1.0);
+        __m256d hh = _mm256_blendv_pd(h, _mm256_setzero_pd(),
+                         _mm256_cmp_pd(h, _mm256_set1_pd(360.0), _CMP_GE_OQ));
+        hh = _mm256_div_pd(hh, _mm256_set1_pd(60.0));
+        const __m256d valid = _mm256_cmp_pd(hh, _mm256_set1_pd(-1.0),
+                                            _CMP_GT_OQ);
+        const __m256d i = _mm256_blendv_pd(_mm256_set1_pd(5.0),
+                              _mm256_round_pd(hh, _MM_FROUND_TO_ZERO
+                                                  | _MM_FROUND_NO_EXC),
+                              valid);
+        const __m256d f = _mm256_sub_pd(hh, i);
+        const __m256d p = _mm256_mul_pd(v, _mm256_sub_pd(one, s));
+        const __m256d q = _mm256_mul_pd(v, _mm256_sub_pd(one,
+                                                         _mm256_mul_pd(s, f)));
+        const __m256d t = _mm256_mul_pd(v, _mm256_sub_pd(one,
+                              _mm256_mul_pd(s, _mm256_sub_pd(one, f))));
+        __m256d is[5];
+        for(int k = 0; k != 5; ++k)
+            is[k] = _mm256_cmp_pd(i, _mm256_set1_pd(double(k)), _CMP_EQ_OQ);
+        __m256d r = v;
+        r = _mm256_blendv_pd(r, q, is[1]);
+        r = _mm256_blendv_pd(r, p, _mm256_or_pd(is[2], is[3]));
+        r = _mm256_blendv_pd(r, t, is[4]);
+        __m256d g = p;
+        g = _mm256_blendv_pd(g, t, is[0]);
+        g = _mm256_blendv_pd(g, v, _mm256_or_pd(is[1], is[2]));
+        g = _mm256_blendv_pd(g, q, is[3]);
+        __m256d b = q;
+        b = _mm256_blendv_pd(b, p, _mm256_or_pd(is[0], is[1]));
+        b = _mm256_blendv_pd(b, t, is[2]);
+        b = _mm256_blendv_pd(b, v, _mm256_or_pd(is[3], is[4]));
+        const __m256d gray = _mm256_cmp_pd(s, _mm256_setzero_pd(),
+                                           _CMP_LE_OQ);
+        const __m256d vscale = _mm256_set1_pd(scale);
+        c[0] = _mm256_mul_pd(vscale, _mm256_blendv_pd(r, v, gray));
+        c[1] = _mm256_mul_pd(vscale, _mm256_blendv_pd(g, v, gray));
+        c[2] = _mm256_mul_pd(vscale, _mm256_blendv_pd(b, v, gray));
+    }
+    ///Eight lane HSVToRGB
+    __attribute__((target("avx512f,avx2")))
+    static void HSVToRGB(__m512d* c, double scale) {
+        const __m512d h = c[0];
+        const __m512d s = c[1];
+        const __m512d v = c[2];
+        const __m512d one = _mm512_set1_pd(1.0);
+        __m512d hh = _mm512_mask_blend_pd(
+                         _mm512_cmp_pd_mask(h, _mm512_set1_pd(360.0),
+                                            _CMP_GE_OQ),
+                         h, _mm512_setzero_pd());
+        hh = _mm512_div_pd(hh, _mm512_set1_pd(60.0));
+        const __mmask8 valid = _mm512_cmp_pd_mask(hh, _mm512_set1_pd(-1.0),
+                                                  _CMP_GT_OQ);
+        const __m512d i = _mm512_mask_blend_pd(valid, _mm512_set1_pd(5.0),
+                              _mm512_roundscale_pd(hh, _MM_FROUND_TO_ZERO
+                                                       | _MM_FROUND_NO_EXC));
+        const __m512d f = _mm512_sub_pd(hh, i);
+        const __m512d p = _mm512_mul_pd(v, _mm512_sub_pd(one, s));
+        const __m512d q = _mm512_mul_pd(v, _mm512_sub_pd(one,
+                                                         _mm512_mul_pd(s, f)));
+        const __m512d t = _mm512_mul_pd(v, _mm512_sub_pd(one,
+                              _mm512_mul_pd(s, _mm512_sub_pd(one, f))));
+        __mmask8 is[5];
+        for(int k = 0; k != 5; ++k)
+            is[k] = _mm512_cmp_pd_mask(i, _mm512_set1_pd(double(k)),
+                                       _CMP_EQ_OQ);
+        __m512d r = v;
+        r = _mm512_mask_blend_pd(is[1], r, q);
+        r = _mm512_mask_blend_pd(is[2] | is[3], r, p);
+        r = _mm512_mask_blend_pd(is[4], r, t);
+        __m512d g = p;
+        g = _mm512_mask_blend_pd(is[0], g, t);
+        g = _mm512_mask_blend_pd(is[1] | is[2], g, v);
+        g = _mm512_mask_blend_pd(is[3], g, q);
+        __m512d b = q;
+        b = _mm512_mask_blend_pd(is[0] | is[1], b, p);
+        b = _mm512_mask_blend_pd(is[2], b, t);
+        b = _mm512_mask_blend_pd(is[3] | is[4], b, v);
+        const __mmask8 gray = _mm512_cmp_pd_mask(s, _mm512_setzero_pd(),
+                                                 _CMP_LE_OQ);
+        const __m512d vscale = _mm512_set1_pd(scale);
+        c[0] = _mm512_mul_pd(vscale, _mm512_mask_blend_pd(gray, r, v));
+        c[1] = _mm512_mul_pd(vscale, _mm512_mask_blend_pd(gray, g, v));
+        c[2] = _mm512_mul_pd(vscale, _mm512_mask_blend_pd(gray, b, v));
+    }
+#endif
+private:
+    void MapScalar(const double* in, std::size_t n, ColorType* out,
+                   double minVal, double invRange) const {
+        for(std::size_t i = 0; i != n; ++i, out += 3) {
+            double t = (in[i] - minVal) * invRange;
+            if(!(t > first_)) t = first_;
+            if(t > last_) t = last_;
+            std::size_t s = 0;
+            for(std::size_t step = std::size_t(1) << levels_ >> 1; step;
+                step >>= 1) {
+                if(search_[s + step - 1] <= t) s += step;
+            }
+            const double u = (t - key_[s]) * invWidth_[s];
+            double v[3];
+            for(int ch = 0; ch != 3; ++ch) {
+                const double* c = &coeff_[4 * ch * nseg_ + s];
+                v[ch] = ((c[3 * nseg_] * u + c[2 * nseg_]) * u
+                         + c[nseg_]) * u + c[0];
+            }
+            if(hsv_) HSVToRGB(v, scale_);
+            for(int ch = 0; ch != 3; ++ch) out[ch] = Saturate(v[ch]);
+        }
+    }
+#ifdef SCOLOR_X86_SIMD
+    __attribute__((target("avx2")))
+    std::size_t MapAVX2(const double* in, std::size_t n, ColorType* out,
+                        double minVal, double invRange) const {
+        //vgatherdpd based binary search is slower than the scalar code on
+        //most CPUs: large maps are left to the scalar path
+        if(nseg_ > LINEAR_SEARCH_SIZE) return 0;
+        const std::size_t nv = n - n % 4;
+        const __m256d vmin = _mm256_set1_pd(minVal);
+        const __m256d vinv = _mm256_set1_pd(invRange);
+        const __m256d vfirst = _mm256_set1_pd(first_);
+        const __m256d vlast = _mm256_set1_pd(last_);
+        const __m256d zero = _mm256_setzero_pd();
+        const __m256d v255 = _mm256_set1_pd(255.0);
+        const __m256d vone = _mm256_set1_pd(1.0);
+        const double* search = search_.data();
+        const int nseg = int(nseg_);
+        for(std::size_t i = 0; i != nv; i += 4, out += 12) {
+            __m256d t = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(in + i),
+                                                    vmin), vinv);
+            //NaN -> first key
+            t = _mm256_min_pd(_mm256_max_pd(t, vfirst), vlast);
+            //segment = number of interior keys <= t
+            __m256d count = zero;
+            for(int k = 0; k != nseg - 1; ++k) {
+                const __m256d le = _mm256_cmp_pd(_mm256_set1_pd(search[k]),
+                                                 t, _CMP_LE_OQ);
+                count = _mm256_add_pd(count, _mm256_and_pd(le, vone));
+            }
+            const __m128i s = _mm256_cvttpd_epi32(count);
+            alignas(16) int si[4];
+            _mm_store_si128(reinterpret_cast< __m128i* >(si), s);
+            const __m256d u = _mm256_mul_pd(
+                _mm256_sub_pd(t, Gather4(key_.data(), si)),
+                Gather4(invWidth_.data(), si));
+            __m256d v[3];
+            for(int ch = 0; ch != 3; ++ch) {
+                const double* c = &coeff_[4 * ch * nseg_];
+                v[ch] = Gather4(c + 3 * nseg, si);
+                v[ch] = _mm256_add_pd(_mm256_mul_pd(v[ch], u),
+                                      Gather4(c + 2 * nseg, si));
+                v[ch] = _mm256_add_pd(_mm256_mul_pd(v[ch], u),
+                                      Gather4(c + nseg, si));
+                v[ch] = _mm256_add_pd(_mm256_mul_pd(v[ch], u), Gather4(c, si));
+            }
+            if(hsv_) HSVToRGB(v, scale_);
+            __m128i rgb[3];
+            for(int ch = 0; ch != 3; ++ch) {
+                const __m256d c = _mm256_min_pd(_mm256_max_pd(v[ch], zero),
+                                                v255);
+                rgb[ch] = _mm256_cvttpd_epi32(c);
+            }
+            Store4RGB(rgb[0], rgb[1], rgb[2], out);
+        }
+        return nv;
+    }
+    __attribute__((target("avx512f,avx2")))
+    std::size_t MapAVX512(const double* in, std::size_t n, ColorType* out,
+                          double minVal, double invRange) const {
+        const std::size_t nv = n - n % 8;
+        const __m512d vmin = _mm512_set1_pd(minVal);
+        const __m512d vinv = _mm512_set1_pd(invRange);
+        const __m512d vfirst = _mm512_set1_pd(first_);
+        const __m512d vlast = _mm512_set1_pd(last_);
+        const __m512d zero = _mm512_setzero_pd();
+        const __m512d v255 = _mm512_set1_pd(255.0);
+        const __m512i one = _mm512_set1_epi64(1);
+        const double* search = search_.data();
+        const int nseg = int(nseg_);
+        for(std::size_t i = 0; i != nv; i += 8, out += 24) {
+            __m512d t = _mm512_mul_pd(_mm512_sub_pd(_mm512_loadu_pd(in + i),
+                                                    vmin), vinv);
+            //NaN -> first key
+            t = _mm512_min_pd(_mm512_max_pd(t, vfirst), vlast);
+            __m256i s = _mm256_setzero_si256();
+            if(nseg <= LINEAR_SEARCH_SIZE) {
+                //segment = number of interior keys <= t
+                __m512i count = _mm512_setzero_si512();
+                for(int k = 0; k != nseg - 1; ++k) {
+                    const __mmask8 le = _mm512_cmp_pd_mask(
+                                            _mm512_set1_pd(search[k]), t,
+                                            _CMP_LE_OQ);
+                    count = _mm512_mask_add_epi64(count, le, count, one);
+                }
+                s = _mm512_cvtepi64_epi32(count);
+            } else for(int step = (1 << levels_) >> 1; step; step >>= 1) {
+                const __m256i idx = _mm256_set1_epi32(step - 1);
+                const __m512d k = _mm512_i32gather_pd(
+                                      _mm256_add_epi32(s, idx), search, 8);
+                const __mmask8 le = _mm512_cmp_pd_mask(k, t, _CMP_LE_OQ);
+                s = _mm512_castsi512_si256(
+                        _mm512_mask_add_epi32(_mm512_zextsi256_si512(s), le,
+                                              _mm512_zextsi256_si512(s),
+                                              _mm512_set1_epi32(step)));
+            }
+            const __m512d u = _mm512_mul_pd(
+                _mm512_sub_pd(t, _mm512_i32gather_pd(s, key_.data(), 8)),
+                _mm512_i32gather_pd(s, invWidth_.data(), 8));
+            __m512d v[3];
+            for(int ch = 0; ch != 3; ++ch) {
+                const double* c = &coeff_[4 * ch * nseg_];
+                v[ch] = _mm512_i32gather_pd(s, c + 3 * nseg, 8);
+                v[ch] = _mm512_add_pd(_mm512_mul_pd(v[ch], u),
+                            _mm512_i32gather_pd(s, c + 2 * nseg, 8));
+                v[ch] = _mm512_add_pd(_mm512_mul_pd(v[ch], u),
+                            _mm512_i32gather_pd(s, c + nseg, 8));
+                v[ch] = _mm512_add_pd(_mm512_mul_pd(v[ch], u),
+                            _mm512_i32gather_pd(s, c, 8));
+            }
+            if(hsv_) HSVToRGB(v, scale_);
+            __m256i rgb[3];
+            for(int ch = 0; ch != 3; ++ch) {
+                const __m512d c = _mm512_min_pd(_mm512_max_pd(v[ch], zero),
+                                                v255);
+                rgb[ch] = _mm512_cvttpd_epi32(c);
+            }
+            Store4RGB(_mm256_castsi256_si128(rgb[0]),
+                      _mm256_castsi256_si128(rgb[1]),
+                      _mm256_castsi256_si128(rgb[2]), out);
+            Store4RGB(_mm256_extracti128_si256(rgb[0], 1),
+                      _mm256_extracti128_si256(rgb[1], 1),
+                      _mm256_extracti128_si256(rgb[2], 1), out + 12);
+        }
+        return nv;
+    }
+#endif
+private:
+    bool hsv_;
+    double scale_;
+    std::size_t nseg_ = 0;
+    int levels_ = 0;
+    double first_ = 0.0;
+    double last_ = 0.0;
+    ///interior keys padded with +inf, searched to find the segment
+    std::vector< double > search_;
+    ///first key and inverse width of each segment
+    std::vector< double > key_;
+    std::vector< double > invWidth_;
+    ///SoA polynomial coefficients: coeff_[(4 * channel + power) * nseg + s]
+    std::vector< double > coeff_;
+};
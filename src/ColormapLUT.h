@@ -0,0 +1,239 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cassert>
+#include <stdexcept>
+#include <algorithm>
+
+#include "Vector3D.h"
+#include "hsvrgb.h"
+#include "CatmullRom.h"
+#include "LinearInterpolation.h"
+#include "io.h"
+
+//------------------------------------------------------------------------------
+///Colormap baked into a dense RGB8 lookup table.
+///The colormap is sampled once over the normalized [0,1] parameter range,
+///colorizing a frame is then a normalize-and-index pass over the data.
+///By default each entry holds the color at the center of its bin; with
+///@c exactEndpoints the first and last entries hold the exact colors at 0 and
+///1 and the scalars are rounded to the nearest entry instead, so that the
+///minimum and maximum of a frame are mapped to the exact end colors.
+class ColormapLUT {
+public:
+    enum {DEFAULT_SIZE = 4096};
+    ColormapLUT() = default;
+    ///Sample @c f: [0,1] -> Vector3D< double > in the [0, 255] range
+    template < typename F >
+    ColormapLUT(F f, std::size_t size = DEFAULT_SIZE,
+                bool exactEndpoints = false)
+        : table_(3 * size), exactEndpoints_(exactEndpoints) {
+        if(size < 2) throw std::logic_error("Invalid LUT size");
+        const double n = double(size);
+        scale_ = exactEndpoints ? n - 1 : n;
+        bias_ = exactEndpoints ? 0.5 : 0.0;
+        for(std::size_t i = 0; i != size; ++i) {
+            const double t = exactEndpoints ? double(i) / (n - 1)
+                                            : (double(i) + 0.5) / n;
+            const Vector3D< double > c = f(t);
+            table_[3 * i]     = Clamp(c[0]);
+            table_[3 * i + 1] = Clamp(c[1]);
+            table_[3 * i + 2] = Clamp(c[2]);
+        }
+    }
+    std::size_t Size() const { return table_.size() / 3; }
+    bool ExactEndpoints() const { return exactEndpoints_; }
+    const ColorType* Data() const { return table_.data(); }
+    ///Index of the entry matching the normalized value @c u; values outside
+    ///[0,1] and NaNs are clamped to the first or last entry
+    std::size_t Index(double u) const {
+        const double x = u * scale_ + bias_;
+        if(!(x > 0.0)) return 0;
+        const std::size_t last = Size() - 1;
+        return x >= double(last) ? last : std::size_t(x);
+    }
+    const ColorType* Lookup(double u) const {
+        return &table_[3 * Index(u)];
+    }
+    ///Colorize [begin, end) into @c out which must hold 3 * (end - begin)
+    ///elements
+    template < typename ScalarT >
+    void Map(const ScalarT* begin, const ScalarT* end, ColorType* out,
+             ScalarT minVal, ScalarT maxVal) const {
+        assert(maxVal >= minVal);
+        const double range = double(maxVal) - double(minVal);
+        const double invRange = range > 0.0 ? 1.0 / range : 0.0;
+        const double m = double(minVal);
+        const ColorType* t = table_.data();
+        for(; begin != end; ++begin, out += 3) {
+            const ColorType* c = t + 3 * Index((double(*begin) - m) * invRange);
+            out[0] = c[0];
+            out[1] = c[1];
+            out[2] = c[2];
+        }
+    }
+    ///Palette indices of [begin, end) into @c out, which must hold
+    ///end - begin elements: same entries as Map, the table is the palette.
+    ///Requires Size() <= 256
+    template < typename ScalarT >
+    void MapIndex(const ScalarT* begin, const ScalarT* end,
+                  unsigned char* out, ScalarT minVal, ScalarT maxVal) const {
+        assert(maxVal >= minVal);
+        assert(Size() <= 256);
+        const double range = double(maxVal) - double(minVal);
+        const double invRange = range > 0.0 ? 1.0 / range : 0.0;
+        const double m = double(minVal);
+        for(; begin != end; ++begin, ++out) {
+            *out = (unsigned char)(Index((double(*begin) - m) * invRange));
+        }
+    }
+    ///Colors of all the integer values in [minVal, maxVal], for MapInteger:
+    ///same colors as Map, but computed once per value instead of per pixel
+    template < typename IntT >
+    std::vector< ColorType > IntegerTable(IntT minVal, IntT maxVal) const {
+        std::vector< ColorType > t;
+        IntegerTable(minVal, maxVal, t);
+        return t;
+    }
+    ///IntegerTable stored into @c t, which is reused if large enough
+    template < typename IntT >
+    void IntegerTable(IntT minVal, IntT maxVal,
+                      std::vector< ColorType >& t) const {
+        assert(maxVal >= minVal);
+        const std::size_t n = std::size_t((long long)(maxVal)
+                                          - (long long)(minVal)) + 1;
+        const double range = double(maxVal) - double(minVal);
+        const double invRange = range > 0.0 ? 1.0 / range : 0.0;
+        t.resize(3 * n);
+        for(std::size_t i = 0; i != n; ++i) {
+            const ColorType* c = Lookup(double(i) * invRange);
+            t[3 * i]     = c[0];
+            t[3 * i + 1] = c[1];
+            t[3 * i + 2] = c[2];
+        }
+    }
+    ///Colorize integer data through a table returned by IntegerTable,
+    ///no floating point operation per pixel
+    template < typename IntT >
+    static void MapInteger(const IntT* begin, const IntT* end, ColorType* out,
+                           const std::vector< ColorType >& table,
+                           IntT minVal) {
+        const ColorType* t = table.data();
+        const long long last = (long long)(table.size() / 3) - 1;
+        for(; begin != end; ++begin, out += 3) {
+            long long i = (long long)(*begin) - (long long)(minVal);
+            i = i < 0 ? 0 : i > last ? last : i;
+            const ColorType* c = t + 3 * i;
+            out[0] = c[0];
+            out[1] = c[1];
+            out[2] = c[2];
+        }
+    }
+private:
+    static ColorType Clamp(double v) {
+        return v > 255.0 ? ColorType(255)
+                         : v > 0.0 ? ColorType(v) : ColorType(0);
+    }
+private:
+    std::vector< ColorType > table_;
+    double scale_ = 0.0;
+    double bias_ = 0.0;
+    bool exactEndpoints_ = false;
+};
+
+//------------------------------------------------------------------------------
+///Map data through lookup table, min and max values are mapped to [0,1]
+template < typename ScalarT >
+std::vector< ColorType >
+LUTScalarToRGB(const std::vector< ScalarT >& data,
+               const ColormapLUT& lut,
+               ScalarT minVal,
+               ScalarT maxVal) {
+    std::vector< ColorType > out(data.size() * 3);
+    if(data.empty()) return out;
+    lut.Map(data.data(), data.data() + data.size(), out.data(),
+            minVal, maxVal);
+    return out;
+}
+
+//------------------------------------------------------------------------------
+//Factory functions, one per *ScalarToRGB variant: same parameters minus
+//the data and the data range
+
+///Lookup table for CRKScalarToRGB
+inline ColormapLUT
+CRKLUT(const std::vector< Vector3D< double > >& colors,
+       const std::vector< double >& keys,
+       double scalingFactor = 1.0,
+       std::size_t size = ColormapLUT::DEFAULT_SIZE,
+       bool exactEndpoints = false) {
+    const CompiledSpline< double > spline(colors, keys);
+    return ColormapLUT([&](double t) {
+        return scalingFactor * spline(t);
+    }, size, exactEndpoints);
+}
+
+///Lookup table for CRKScalarHSVToRGB
+inline ColormapLUT
+CRKHSVLUT(const std::vector< Vector3D< double > >& colors,
+          const std::vector< double >& keys,
+          double scalingFactor = 1.0,
+          std::size_t size = ColormapLUT::DEFAULT_SIZE,
+          bool exactEndpoints = false) {
+    const CompiledSpline< double > spline(colors, keys);
+    return ColormapLUT([&](double t) {
+        const Vector3D< double > v = spline(t);
+        const rgb c = hsv2rgb(hsv(v[0], v[1], v[2]));
+        return Vector3D< double >(scalingFactor * c.r,
+                                  scalingFactor * c.g,
+                                  scalingFactor * c.b);
+    }, size, exactEndpoints);
+}
+
+///Lookup table for LScalarToRGB
+inline ColormapLUT
+LLUT(const std::vector< Vector3D< double > >& colors,
+     const std::vector< double >& keys,
+     double normFactor = 1.0,
+     std::size_t size = ColormapLUT::DEFAULT_SIZE,
+     bool exactEndpoints = false) {
+    return ColormapLUT([&](double t) {
+        return normFactor * LinearInterpolation(colors, keys, t, 0.0, 1.0);
+    }, size, exactEndpoints);
+}
+
+///Lookup table for LScalarHSVToRGB
+inline ColormapLUT
+LHSVLUT(const std::vector< Vector3D< double > >& colors,
+        const std::vector< double >& keys,
+        double normFactor = 1.0,
+        std::size_t size = ColormapLUT::DEFAULT_SIZE,
+        bool exactEndpoints = false) {
+    return ColormapLUT([&](double t) {
+        const Vector3D< double > v =
+            LinearInterpolation(colors, keys, t, 0.0, 1.0);
+        const rgb c = hsv2rgb(hsv(v[0], v[1], v[2]));
+        return Vector3D< double >(normFactor * c.r,
+                                  normFactor * c.g,
+                                  normFactor * c.b);
+    }, size, exactEndpoints);
+}
+
+///Lookup table of a discrete (step) colormap: the colors are used as they
+///are, [0, 1] is split into one equal bin per color; with @c hsvColors the
+///colors are converted from HSV
+inline ColormapLUT
+StepLUT(const std::vector< Vector3D< double > >& colors,
+        bool hsvColors = false,
+        double normFactor = 1.0) {
+    const double n = double(colors.size());
+    return ColormapLUT([&](double t) {
+        const std::size_t i = std::min(colors.size() - 1, std::size_t(t * n));
+        Vector3D< double > v = colors[i];
+        if(hsvColors) {
+            const rgb c = hsv2rgb(hsv(v[0], v[1], v[2]));
+            v = Vector3D< double >(c.r, c.g, c.b);
+        }
+        return normFactor * v;
+    }, colors.size());
+}
@@ -0,0 +1,188 @@
+#pragma once
+#include <cstddef>
+#include <deque>
+#include <vector>
+#include <map>
+#include <string>
+#include <iostream>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <utility>
+
+//------------------------------------------------------------------------------
+///Multiple producer/multiple consumer FIFO queue with a maximum capacity:
+///Push blocks while the queue is full and Pop blocks while it is empty.
+///After Close, Push fails and Pop returns the remaining elements then fails;
+///Close(true) also discards the queued elements.
+template < typename T >
+class BoundedQueue {
+public:
+    explicit BoundedQueue(std::size_t capacity) : capacity_(capacity) {}
+    bool Push(T v) {
+        std::unique_lock< std::mutex > lock(mutex_);
+        notFull_.wait(lock, [this]() {
+            return closed_ || queue_.size() < capacity_;
+        });
+        if(closed_) return false;
+        queue_.push_back(std::move(v));
+        notEmpty_.notify_one();
+        return true;
+    }
+    bool Pop(T& v) {
+        std::unique_lock< std::mutex > lock(mutex_);
+        notEmpty_.wait(lock, [this]() {
+            return closed_ || !queue_.empty();
+        });
+        if(queue_.empty()) return false;
+        v = std::move(queue_.front());
+        queue_.pop_front();
+        notFull_.notify_one();
+        return true;
+    }
+    void Close(bool discard = false) {
+        std::lock_guard< std::mutex > lock(mutex_);
+        closed_ = true;
+        if(discard) queue_.clear();
+        notFull_.notify_all();
+        notEmpty_.notify_all();
+    }
+private:
+    std::deque< T > queue_;
+    std::size_t capacity_;
+    bool closed_ = false;
+    std::mutex mutex_;
+    std::condition_variable notFull_;
+    std::condition_variable notEmpty_;
+};
+
+//------------------------------------------------------------------------------
+///Pool of reusable objects, e.g. the frame buffers handed from one pipeline
+///stage to the next: buffers are returned to the pool once consumed instead
+///of being destroyed, after the first few frames every frame reuses the
+///memory of a previous one.
+template < typename T >
+class ObjectPool {
+public:
+    ///Pooled object, default constructed if the pool is empty
+    T Get() {
+        std::lock_guard< std::mutex > lock(mutex_);
+        if(free_.empty()) return T();
+        T v = std::move(free_.back());
+        free_.pop_back();
+        return v;
+    }
+    void Put(T v) {
+        std::lock_guard< std::mutex > lock(mutex_);
+        free_.push_back(std::move(v));
+    }
+private:
+    std::vector< T > free_;
+    std::mutex mutex_;
+};
+
+//------------------------------------------------------------------------------
+///Print text generated out of order by multiple threads in frame order
+class OrderedOutput {
+public:
+    OrderedOutput(std::ostream& os, int first) : os_(os), next_(first) {}
+    void Put(int index, std::string text) {
+        std::lock_guard< std::mutex > lock(mutex_);
+        pending_[index] = std::move(text);
+        std::map< int, std::string >::iterator i = pending_.begin();
+        while(i != pending_.end() && i->first == next_) {
+            os_ << i->second;
+            i = pending_.erase(i);
+            ++next_;
+        }
+        os_.flush();
+    }
+private:
+    std::ostream& os_;
+    int next_;
+    std::map< int, std::string > pending_;
+    std::mutex mutex_;
+};
+
+//------------------------------------------------------------------------------
+///Three stage frame pipeline: one reader thread, a pool of processing threads
+///and a pool of writer threads connected through bounded queues, such that
+///reading, processing and encoding of different frames overlap.
+///
+/// - read(int frame) -> R
+/// - process(int frame, R&&) -> P
+/// - write(int writer, int frame, P&&)
+///
+///@c writer is the index in [0, writeThreads) of the calling writer thread,
+///per-thread encoder state is kept by the caller and indexed by it.
+///Frames are handed to the processing and writer pools in order but can
+///complete out of order, the per-frame results do not depend on the
+///scheduling.
+///The first exception thrown by any stage stops the pipeline and is rethrown
+///to the caller.
+template < typename ReadF, typename ProcessF, typename WriteF >
+void FramePipeline(int first, int last,
+                   int processThreads, int writeThreads,
+                   std::size_t queueSize,
+                   ReadF read, ProcessF process, WriteF write) {
+    using R = decltype(read(first));
+    using P = decltype(process(first, std::declval< R >()));
+    using RItem = std::pair< int, R >;
+    using PItem = std::pair< int, P >;
+    BoundedQueue< RItem > readQueue(queueSize);
+    BoundedQueue< PItem > writeQueue(queueSize);
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    auto fail = [&]() {
+        {
+            std::lock_guard< std::mutex > lock(errorMutex);
+            if(!error) error = std::current_exception();
+        }
+        readQueue.Close(true);
+        writeQueue.Close(true);
+    };
+    std::atomic< int > activeProcessThreads(processThreads);
+    std::vector< std::thread > threads;
+    threads.push_back(std::thread([&]() {
+        try {
+            for(int f = first; f <= last; ++f) {
+                if(!readQueue.Push(RItem(f, read(f)))) break;
+            }
+        } catch(...) {
+            fail();
+        }
+        readQueue.Close();
+    }));
+    for(int i = 0; i < processThreads; ++i) {
+        threads.push_back(std::thread([&]() {
+            try {
+                RItem r;
+                while(readQueue.Pop(r)) {
+                    const int f = r.first;
+                    if(!writeQueue.Push(PItem(f, process(f,
+                                                 std::move(r.second)))))
+                        break;
+                }
+            } catch(...) {
+                fail();
+            }
+            if(--activeProcessThreads == 0) writeQueue.Close();
+        }));
+    }
+    for(int i = 0; i < writeThreads; ++i) {
+        threads.push_back(std::thread([&, i]() {
+            try {
+                PItem p;
+                while(writeQueue.Pop(p)) {
+                    write(i, p.first, std::move(p.second));
+                }
+            } catch(...) {
+                fail();
+            }
+        }));
+    }
+    for(auto& t: threads) t.join();
+    if(error) std::rethrow_exception(error);
+}
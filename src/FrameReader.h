@@ -0,0 +1,596 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <stdexcept>
+#include <exception>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <utility>
+#include <memory>
+#include <algorithm>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define SCOLOR_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+//------------------------------------------------------------------------------
+///Bytes read, time spent with at least one frame being opened or read and
+///time the frame requests blocked waiting for the data
+struct ReadStats {
+    std::size_t frames = 0;
+    std::uint64_t bytes = 0;
+    double seconds = 0.0;
+    double stalled = 0.0;
+    double Bandwidth() const {
+        return seconds > 0.0 ? double(bytes) / seconds : 0.0;
+    }
+};
+
+namespace detail {
+#ifdef SCOLOR_IO_URING
+//------------------------------------------------------------------------------
+///Minimal io_uring instance through the raw system calls: queue opens,
+///statx calls and reads, into registered buffers or not, and wait for their
+///completion. Not thread safe. Throws if io_uring is not available
+class IOUring {
+public:
+    explicit IOUring(unsigned entries) {
+        io_uring_params p;
+        std::memset(&p, 0, sizeof(p));
+        fd_ = int(syscall(__NR_io_uring_setup, entries, &p));
+        if(fd_ < 0) throw std::runtime_error("io_uring not available");
+        sqSize_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cqSize_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        const bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+        if(single) sqSize_ = cqSize_ = std::max(sqSize_, cqSize_);
+        sqesSize_ = p.sq_entries * sizeof(io_uring_sqe);
+        try {
+            sq_ = Map(sqSize_, IORING_OFF_SQ_RING);
+            cq_ = single ? sq_ : Map(cqSize_, IORING_OFF_CQ_RING);
+            sqes_ = static_cast< io_uring_sqe* >(Map(sqesSize_,
+                                                     IORING_OFF_SQES));
+        } catch(...) {
+            Close();
+            throw;
+        }
+        char* sq = static_cast< char* >(sq_);
+        char* cq = static_cast< char* >(cq_);
+        sqTail_ = reinterpret_cast< unsigned* >(sq + p.sq_off.tail);
+        sqMask_ = *reinterpret_cast< unsigned* >(sq + p.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast< unsigned* >(sq + p.sq_off.array);
+        cqHead_ = reinterpret_cast< unsigned* >(cq + p.cq_off.head);
+        cqTail_ = reinterpret_cast< unsigned* >(cq + p.cq_off.tail);
+        cqMask_ = *reinterpret_cast< unsigned* >(cq + p.cq_off.ring_mask);
+        cqes_ = reinterpret_cast< io_uring_cqe* >(cq + p.cq_off.cqes);
+        entries_ = p.sq_entries;
+    }
+    IOUring(const IOUring&) = delete;
+    IOUring& operator=(const IOUring&) = delete;
+    ~IOUring() { Close(); }
+    unsigned Entries() const { return entries_; }
+    ///True if the kernel supports all the operations @c ops
+    bool Supports(const std::vector< int >& ops) const {
+        const unsigned n = 256;
+        std::vector< char > buffer(sizeof(io_uring_probe)
+                                   + n * sizeof(io_uring_probe_op));
+        io_uring_probe* p = reinterpret_cast< io_uring_probe* >(buffer.data());
+        if(syscall(__NR_io_uring_register, fd_, IORING_REGISTER_PROBE, p, n)
+           != 0) return false;
+        for(int op: ops) {
+            if(op > p->last_op || !(p->ops[op].flags & IO_URING_OP_SUPPORTED))
+                return false;
+        }
+        return true;
+    }
+    ///Register the buffers read with index >= 0 in Read; false if the
+    ///buffers cannot be pinned, e.g. larger than RLIMIT_MEMLOCK
+    bool RegisterBuffers(const std::vector< iovec >& buffers) {
+        return syscall(__NR_io_uring_register, fd_, IORING_REGISTER_BUFFERS,
+                       buffers.data(), unsigned(buffers.size())) == 0;
+    }
+    ///Queue a request completing right away, e.g. to wake up Wait
+    void Nop(std::uint64_t userData) {
+        io_uring_sqe& e = Next();
+        e.opcode = IORING_OP_NOP;
+        e.user_data = userData;
+    }
+    ///Queue the opening of file @c path for reading, the result is the file
+    ///descriptor; @c path must stay valid until completion
+    void Open(const char* path, std::uint64_t userData) {
+        io_uring_sqe& e = Next();
+        e.opcode = IORING_OP_OPENAT;
+        e.fd = AT_FDCWD;
+        e.addr = std::uint64_t(reinterpret_cast< std::uintptr_t >(path));
+        e.open_flags = O_RDONLY | O_CLOEXEC;
+        e.user_data = userData;
+    }
+    ///Queue a statx call on file @c path filling the fields of @c mask in
+    ///@c st; @c path and @c st must stay valid until completion
+    void Statx(const char* path, unsigned mask, struct statx* st,
+               std::uint64_t userData) {
+        io_uring_sqe& e = Next();
+        e.opcode = IORING_OP_STATX;
+        e.fd = AT_FDCWD;
+        e.addr = std::uint64_t(reinterpret_cast< std::uintptr_t >(path));
+        e.len = mask;
+        e.off = std::uint64_t(reinterpret_cast< std::uintptr_t >(st));
+        e.user_data = userData;
+    }
+    ///Queue a read of @c length bytes at @c offset, @c buffer is the index
+    ///of the registered buffer @c data is in, -1 = not registered; at most
+    ///Entries() requests can be queued between two Submit calls. Submission
+    ///and Wait can be called from different threads
+    void Read(int fd, void* data, unsigned length, std::uint64_t offset,
+              int buffer, std::uint64_t userData) {
+        io_uring_sqe& e = Next();
+        e.opcode = buffer < 0 ? IORING_OP_READ : IORING_OP_READ_FIXED;
+        e.fd = fd;
+        e.addr = std::uint64_t(reinterpret_cast< std::uintptr_t >(data));
+        e.len = length;
+        e.off = offset;
+        e.buf_index = std::uint16_t(buffer < 0 ? 0 : buffer);
+        e.user_data = userData;
+    }
+    ///Submit the queued reads
+    void Submit() {
+        if(!queued_) return;
+        __atomic_store_n(sqTail_, *sqTail_ + queued_, __ATOMIC_RELEASE);
+        const unsigned n = queued_;
+        queued_ = 0;
+        for(unsigned submitted = 0; submitted < n;) {
+            const long r = syscall(__NR_io_uring_enter, fd_, n - submitted, 0,
+                                   0, nullptr, 0);
+            if(r < 0 && errno != EINTR && errno != EAGAIN)
+                throw std::runtime_error("io_uring submission failed");
+            if(r > 0) submitted += unsigned(r);
+        }
+    }
+    ///Wait for the next completion: user data and result, the number of
+    ///bytes read or -errno
+    std::pair< std::uint64_t, int > Wait() {
+        for(;;) {
+            const unsigned head = *cqHead_;
+            if(head != __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE)) {
+                const io_uring_cqe& e = cqes_[head & cqMask_];
+                const std::pair< std::uint64_t, int > r(e.user_data, e.res);
+                __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+                return r;
+            }
+            const long r = syscall(__NR_io_uring_enter, fd_, 0, 1,
+                                   IORING_ENTER_GETEVENTS, nullptr, 0);
+            if(r < 0 && errno != EINTR)
+                throw std::runtime_error("io_uring wait failed");
+        }
+    }
+private:
+    void* Map(std::size_t size, off_t offset) {
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, fd_, offset);
+        if(p == MAP_FAILED) throw std::runtime_error("io_uring not available");
+        return p;
+    }
+    ///Cleared submission queue entry at the tail
+    io_uring_sqe& Next() {
+        const unsigned i = (*sqTail_ + queued_) & sqMask_;
+        sqArray_[i] = i;
+        ++queued_;
+        io_uring_sqe& e = sqes_[i];
+        std::memset(&e, 0, sizeof(e));
+        return e;
+    }
+    void Close() {
+        if(sqes_) munmap(sqes_, sqesSize_);
+        if(cq_ && cq_ != sq_) munmap(cq_, cqSize_);
+        if(sq_) munmap(sq_, sqSize_);
+        close(fd_);
+    }
+private:
+    int fd_ = -1;
+    void* sq_ = nullptr;
+    void* cq_ = nullptr;
+    io_uring_sqe* sqes_ = nullptr;
+    std::size_t sqSize_ = 0;
+    std::size_t cqSize_ = 0;
+    std::size_t sqesSize_ = 0;
+    unsigned* sqTail_ = nullptr;
+    unsigned sqMask_ = 0;
+    unsigned* sqArray_ = nullptr;
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    unsigned cqMask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned entries_ = 0;
+    unsigned queued_ = 0;
+};
+#endif
+} //namespace detail
+
+//------------------------------------------------------------------------------
+///Asynchronous reader of a sequence of frame files: keeps the next @c depth
+///frames in flight while the current ones are processed, frames are read
+///into buffers recycled from a pool instead of being mapped. Files are
+///opened and their size queried asynchronously as well, the metadata
+///latency of a parallel file system is overlapped like the reads.
+///Opens, statx calls and reads go through io_uring, into buffers registered
+///with the kernel when possible, with a thread reaping the completions; or
+///through @c depth + 1 threads calling open, fstat and pread if io_uring is
+///not available. Files are read whole,
+///compressed frames are decompressed by the caller, see Gunzip. Frames are
+///requested in order from one thread, buffers can be recycled from any
+///thread.
+template < typename T >
+class FrameReader {
+public:
+    using NameFunction = std::function< void (int, std::string&) >;
+    ///Read frames [first, last], @c name stores the file name of a frame
+    ///into its second argument
+    FrameReader(const NameFunction& name, int first, int last, int depth)
+        : name_(name), next_(first), last_(last),
+          depth_(std::max(1, depth)) {
+#ifdef SCOLOR_IO_URING
+        try {
+            //room for the open and statx requests, or the read, of the
+            //depth + 1 frames in flight while Get waits, and the stop
+            //request
+            ring_.reset(new detail::IOUring(unsigned(2 * depth_ + 3)));
+            if(!ring_->Supports({IORING_OP_OPENAT, IORING_OP_STATX,
+                                 IORING_OP_READ, IORING_OP_READ_FIXED}))
+                ring_.reset();
+            else workers_.push_back(std::thread([this]() { Reap(); }));
+        } catch(const std::exception&) {
+            ring_.reset();
+        }
+#endif
+        if(!Uring()) {
+            for(int i = 0; i != depth_ + 1; ++i)
+                workers_.push_back(std::thread([this]() { Work(); }));
+        }
+    }
+    FrameReader(const FrameReader&) = delete;
+    FrameReader& operator=(const FrameReader&) = delete;
+    ~FrameReader() {
+        {
+            std::lock_guard< std::mutex > lock(mutex_);
+            stop_ = true;
+#ifdef SCOLOR_IO_URING
+            //the reaper returns once the requests in flight complete
+            if(Uring()) {
+                ring_->Nop(STOP);
+                ring_->Submit();
+            }
+#endif
+        }
+        workCondition_.notify_all();
+        for(std::thread& t: workers_) t.join();
+        for(Slot& s: slots_) if(s.fd >= 0) close(s.fd);
+    }
+    const char* Method() const { return Uring() ? "io_uring" : "pread"; }
+    ///Contents of frame @c f, blocks until read; requests the following
+    ///frames. Frames are returned in order, each one once. The buffer holds
+    ///whole elements rounded up, the size of the file in bytes is stored in
+    ///@c bytes if not null
+    std::vector< T > Get(int f, std::size_t* bytes = nullptr) {
+        if(f != (slots_.empty() ? next_ : slots_.front().frame) || f > last_)
+            throw std::logic_error("Frames out of order");
+        while(next_ <= last_ && next_ - f <= depth_) Request(next_++);
+        std::unique_lock< std::mutex > lock(mutex_);
+        Slot& s = slots_.front();
+        if(!s.complete) {
+            const auto start = std::chrono::steady_clock::now();
+            doneCondition_.wait(lock, [&s]() { return s.complete; });
+            stats_.stalled += std::chrono::duration< double >(
+                std::chrono::steady_clock::now() - start).count();
+        }
+        std::vector< T > b = std::move(s.buffer);
+        if(bytes) *bytes = s.size;
+        const std::exception_ptr error = s.error;
+        if(s.fd >= 0) close(s.fd);
+        slots_.pop_front();
+        if(error) std::rethrow_exception(error);
+        ++stats_.frames;
+        return b;
+    }
+    ///Buffer of a frame returned by Get, for reuse by a later frame
+    void Recycle(std::vector< T >&& b) {
+        std::lock_guard< std::mutex > lock(poolMutex_);
+        pool_.push_back(std::move(b));
+    }
+    ReadStats Stats() const {
+        std::lock_guard< std::mutex > lock(mutex_);
+        return stats_;
+    }
+private:
+    struct Slot {
+        int frame = 0;
+        std::string name;
+        int fd = -1;
+        std::vector< T > buffer;
+        ///bytes to read and read so far
+        std::size_t size = 0;
+        std::size_t done = 0;
+        ///taken by a pread worker
+        bool taken = false;
+        bool complete = false;
+        std::exception_ptr error;
+#ifdef SCOLOR_IO_URING
+        ///open and statx requests not completed yet
+        int opening = 0;
+        struct statx st;
+#endif
+    };
+    ///user data: frame number times the number of operations plus the
+    ///operation, ~0 stops the reaper
+    enum : std::uint64_t {OPEN, STAT, READ, OPERATIONS,
+                          STOP = ~std::uint64_t(0)};
+    bool Uring() const {
+#ifdef SCOLOR_IO_URING
+        return bool(ring_);
+#else
+        return false;
+#endif
+    }
+    ///Recycled buffer for @c n elements: one large enough if any, else one
+    ///that is not registered, since growing a registered buffer would move
+    ///it out of the memory pinned by the kernel; empty if none
+    std::vector< T > Buffer(std::size_t n) {
+        std::lock_guard< std::mutex > lock(poolMutex_);
+        auto i = std::find_if(pool_.begin(), pool_.end(),
+                              [n](const std::vector< T >& b) {
+            return b.capacity() >= n;
+        });
+        if(i == pool_.end()) {
+            i = std::find_if(pool_.begin(), pool_.end(),
+                             [this](const std::vector< T >& b) {
+                return !Registered(b);
+            });
+        }
+        if(i == pool_.end()) return std::vector< T >();
+        std::vector< T > b = std::move(*i);
+        pool_.erase(i);
+        return b;
+    }
+    ///True if the storage of @c b is registered with io_uring; with
+    ///io_uring buffers are only taken and registered by the reaper thread
+    bool Registered(const std::vector< T >& b) const {
+#ifdef SCOLOR_IO_URING
+        for(const iovec& r: registered_)
+            if(r.iov_base == static_cast< const void* >(b.data())) return true;
+#else
+        (void)b;
+#endif
+        return false;
+    }
+    ///Queue frame @c f: opened, sized and read by the workers or through
+    ///io_uring, the requesting thread never waits for the file system
+    void Request(int f) {
+        Slot s;
+        s.frame = f;
+        try {
+            name_(f, s.name);
+        } catch(...) {
+            s.error = std::current_exception();
+            s.complete = true;
+        }
+        std::lock_guard< std::mutex > lock(mutex_);
+        if(active_++ == 0) busyStart_ = std::chrono::steady_clock::now();
+        if(s.complete) Account(0);
+        //slots are not moved by push_back and pop_front, the name and statx
+        //buffer stay valid while requests are in flight
+        slots_.push_back(std::move(s));
+        Slot& q = slots_.back();
+        if(q.complete) return;
+#ifdef SCOLOR_IO_URING
+        if(Uring()) {
+            const std::uint64_t u = std::uint64_t(f) * OPERATIONS;
+            ring_->Open(q.name.c_str(), u + OPEN);
+            ring_->Statx(q.name.c_str(), STATX_SIZE, &q.st, u + STAT);
+            ring_->Submit();
+            q.opening = 2;
+            inFlight_ += 2;
+            return;
+        }
+#endif
+        workCondition_.notify_one();
+    }
+    ///Buffer of slot @c s sized for the file
+    void Size(Slot& s) {
+        const std::size_t n = (s.size + sizeof(T) - 1) / sizeof(T);
+        s.buffer = Buffer(n);
+        s.buffer.resize(n);
+    }
+    ///Account for a frame of @c n bytes read now, with mutex_ locked
+    void Account(std::size_t n) {
+        stats_.bytes += n;
+        if(--active_ == 0) {
+            stats_.seconds += std::chrono::duration< double >(
+                std::chrono::steady_clock::now() - busyStart_).count();
+        }
+    }
+    ///pread worker: reads the first frame not taken by another worker
+    void Work() {
+        std::unique_lock< std::mutex > lock(mutex_);
+        for(;;) {
+            Slot* s = nullptr;
+            workCondition_.wait(lock, [this, &s]() {
+                for(Slot& q: slots_) {
+                    if(!q.complete && !q.taken) {
+                        s = &q;
+                        return true;
+                    }
+                }
+                return stop_;
+            });
+            if(!s) return;
+            s->taken = true;
+            lock.unlock();
+            std::size_t done = 0;
+            std::exception_ptr error;
+            try {
+                struct stat st;
+                s->fd = open(s->name.c_str(), O_RDONLY | O_CLOEXEC);
+                if(s->fd < 0 || fstat(s->fd, &st) != 0)
+                    throw std::runtime_error("Cannot read from file");
+                s->size = std::size_t(st.st_size);
+                Size(*s);
+            } catch(...) {
+                error = std::current_exception();
+            }
+            char* data = reinterpret_cast< char* >(s->buffer.data());
+            while(!error && done < s->size) {
+                const ssize_t r = pread(s->fd, data + done, s->size - done,
+                                        off_t(done));
+                if(r < 0 && errno == EINTR) continue;
+                if(r <= 0) {
+                    error = std::make_exception_ptr(
+                        std::runtime_error("Cannot read from file"));
+                    break;
+                }
+                done += std::size_t(r);
+            }
+            lock.lock();
+            s->done = done;
+            s->error = error;
+            s->complete = true;
+            Account(done);
+            doneCondition_.notify_all();
+        }
+    }
+#ifdef SCOLOR_IO_URING
+    ///Queue the remaining bytes of slot @c s, with mutex_ locked
+    void Queue(Slot& s) {
+        RegisterBuffers(s);
+        char* data = reinterpret_cast< char* >(s.buffer.data()) + s.done;
+        const std::size_t length = std::min(s.size - s.done,
+                                            std::size_t(0x7ffff000));
+        int index = -1;
+        for(std::size_t i = 0; i != registered_.size(); ++i) {
+            const char* b = static_cast< const char* >(registered_[i].iov_base);
+            if(data >= b && data + length <= b + registered_[i].iov_len)
+                index = int(i);
+        }
+        ring_->Read(s.fd, data, unsigned(length), s.done, index,
+                    std::uint64_t(s.frame) * OPERATIONS + READ);
+        ++inFlight_;
+    }
+    ///Register the first depth + 1 buffers, sized after the first frame;
+    ///frames read into other buffers use regular reads
+    void RegisterBuffers(Slot& s) {
+        if(registrationTried_) return;
+        registrationTried_ = true;
+        std::vector< iovec > buffers;
+        std::vector< std::vector< T > > pooled;
+        buffers.push_back({s.buffer.data(), s.size});
+        for(int i = 1; i < depth_ + 1; ++i) {
+            std::vector< T > b = Buffer(s.buffer.size());
+            b.resize(s.buffer.size());
+            buffers.push_back({b.data(), s.size});
+            pooled.push_back(std::move(b));
+        }
+        if(ring_->RegisterBuffers(buffers)) registered_ = buffers;
+        for(std::vector< T >& b: pooled) Recycle(std::move(b));
+    }
+    ///io_uring completion thread: the read of a frame is queued once it is
+    ///open and sized, short reads are queued again for the remaining bytes
+    void Reap() {
+        bool stopping = false;
+        for(;;) {
+            const std::pair< std::uint64_t, int > r = ring_->Wait();
+            std::lock_guard< std::mutex > lock(mutex_);
+            if(r.first == STOP) stopping = true;
+            else {
+                --inFlight_;
+                const int f = int(r.first / OPERATIONS);
+                Slot& s = slots_[std::size_t(f - slots_.front().frame)];
+                if(r.first % OPERATIONS == READ) Completed(s, r.second);
+                else Opened(s, r.first % OPERATIONS, r.second);
+            }
+            if(stopping && !inFlight_) return;
+        }
+    }
+    ///Open or statx request of slot @c s completed with result @c r, with
+    ///mutex_ locked: the read is queued once both succeeded
+    void Opened(Slot& s, std::uint64_t op, int r) {
+        if(op == OPEN && r >= 0) s.fd = r;
+        if(r < 0 && !s.error) {
+            s.error = std::make_exception_ptr(
+                std::runtime_error("Cannot read from file"));
+        }
+        if(--s.opening) return;
+        if(!s.error) {
+            try {
+                s.size = std::size_t(s.st.stx_size);
+                Size(s);
+            } catch(...) {
+                s.error = std::current_exception();
+            }
+        }
+        if(s.error || !s.size) {
+            s.complete = true;
+            Account(0);
+            doneCondition_.notify_all();
+            return;
+        }
+        Queue(s);
+        ring_->Submit();
+    }
+    ///Read of slot @c s completed with result @c r, with mutex_ locked
+    void Completed(Slot& s, int r) {
+        if(r > 0) s.done += std::size_t(r);
+        if(r > 0 && s.done < s.size) {
+            Queue(s);
+            ring_->Submit();
+            return;
+        }
+        if(r <= 0) {
+            s.error = std::make_exception_ptr(
+                std::runtime_error("Cannot read from file"));
+        }
+        s.complete = true;
+        Account(s.done);
+        doneCondition_.notify_all();
+    }
+#endif
+private:
+    NameFunction name_;
+    int next_;
+    int last_;
+    int depth_;
+    ///frames requested and not returned yet, in order
+    std::deque< Slot > slots_;
+    std::vector< std::vector< T > > pool_;
+    std::mutex poolMutex_;
+    ReadStats stats_;
+    ///frames requested and not read yet, since busyStart_
+    int active_ = 0;
+    std::chrono::steady_clock::time_point busyStart_;
+    mutable std::mutex mutex_;
+    std::condition_variable workCondition_;
+    std::condition_variable doneCondition_;
+    bool stop_ = false;
+#ifdef SCOLOR_IO_URING
+    std::unique_ptr< detail::IOUring > ring_;
+    std::vector< iovec > registered_;
+    bool registrationTried_ = false;
+    unsigned inFlight_ = 0;
+#endif
+    std::vector< std::thread > workers_;
+};
@@ -0,0 +1,315 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "Gzip.h"
+
+//------------------------------------------------------------------------------
+///Read-only memory mapped file, move only.
+///The file is mapped with a sequential access hint, unless @c sequential is
+///false, and read-ahead is requested right away, the pages are then shared
+///with the page cache and never copied.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& fname, bool sequential = true) {
+        const int fd = open(fname.c_str(), O_RDONLY);
+        if(fd < 0) throw std::runtime_error("Cannot read from file");
+        struct stat st;
+        if(fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::runtime_error("Cannot read from file");
+        }
+        size_ = std::size_t(st.st_size);
+        if(size_ > 0) {
+            void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(p == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("Cannot map file");
+            }
+            data_ = static_cast< const char* >(p);
+            if(sequential) madvise(p, size_, MADV_SEQUENTIAL);
+            madvise(p, size_, MADV_WILLNEED);
+        }
+        close(fd);
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other)
+        : data_(other.data_), size_(other.size_) {
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    MappedFile& operator=(MappedFile&& other) {
+        if(this != &other) {
+            Unmap();
+            std::swap(data_, other.data_);
+            std::swap(size_, other.size_);
+        }
+        return *this;
+    }
+    ~MappedFile() { Unmap(); }
+    const char* Data() const { return data_; }
+    std::size_t Size() const { return size_; }
+    ///Start reading [offset, offset + length) in the background
+    void Prefetch(std::size_t offset, std::size_t length) const {
+        if(!data_ || offset >= size_) return;
+        const std::size_t page = std::size_t(sysconf(_SC_PAGESIZE));
+        const std::size_t b = offset / page * page;
+        const std::size_t e = std::min(offset + length, size_);
+        madvise(const_cast< char* >(data_) + b, e - b, MADV_WILLNEED);
+    }
+    ///Drop the pages fully contained in [offset, offset + length) from the
+    ///mapping once they are not needed anymore, they are read again from
+    ///the file if accessed; keeps the resident size bounded when streaming
+    ///through files larger than the available memory
+    void Release(std::size_t offset, std::size_t length) const {
+        if(!data_) return;
+        const std::size_t page = std::size_t(sysconf(_SC_PAGESIZE));
+        const std::size_t b = (offset + page - 1) / page * page;
+        const std::size_t e = std::min(offset + length, size_) / page * page;
+        if(e > b) madvise(const_cast< char* >(data_) + b, e - b,
+                          MADV_DONTNEED);
+    }
+private:
+    void Unmap() {
+        if(data_) munmap(const_cast< char* >(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+//------------------------------------------------------------------------------
+inline bool HostIsBigEndian() {
+    const unsigned short one = 1;
+    return *reinterpret_cast< const unsigned char* >(&one) == 0;
+}
+
+template < typename T >
+T ByteSwap(T v) {
+    unsigned char* b = reinterpret_cast< unsigned char* >(&v);
+    std::reverse(b, b + sizeof(T));
+    return v;
+}
+
+//------------------------------------------------------------------------------
+///Frame of scalars read from a raw file: read-only array view over the
+///memory mapped file contents, the data is never copied unless the byte
+///order of the file differs from the host one (@c swapBytes), in which case
+///the frame holds a byte swapped copy. Frames can also be views of a slice
+///of a volume mapped once and shared by all its slices, see Volume, or own
+///a buffer the file was read into, see FrameReader. Gzip compressed files
+///(.gz) are decompressed into the frame by @c threads threads, see Gunzip.
+///Move only.
+template < typename T >
+class ScalarFrame {
+public:
+    using value_type = T;
+    using const_iterator = const T*;
+    ScalarFrame() = default;
+    explicit ScalarFrame(const std::string& fname, bool swapBytes = false,
+                         int threads = 1)
+        : file_(fname),
+          view_(reinterpret_cast< const T* >(file_.Data())),
+          size_(file_.Size() / sizeof(T)) {
+        if(IsGzipFile(fname)) {
+            Gunzip(file_.Data(), file_.Size(), copy_, threads);
+            size_ = copy_.size();
+            file_ = MappedFile();
+            view_ = nullptr;
+            if(swapBytes && sizeof(T) > 1)
+                std::transform(copy_.begin(), copy_.end(), copy_.begin(),
+                               ByteSwap< T >);
+        } else if(swapBytes && sizeof(T) > 1) {
+            copy_.resize(size_);
+            std::transform(view_, view_ + size_, copy_.begin(),
+                           ByteSwap< T >);
+            file_ = MappedFile();
+            view_ = nullptr;
+        }
+    }
+    ///@c width x @c height 2D array of @c volume starting at @c first, with
+    ///element strides @c columnStride along the rows and @c rowStride between
+    ///rows: a view of the mapped data if the rows are contiguous and
+    ///consecutive, a copy with the rows gathered otherwise, byte swapped if
+    ///@c swapBytes
+    ScalarFrame(const std::shared_ptr< const MappedFile >& volume,
+                const T* first, std::size_t width, std::size_t height,
+                std::size_t columnStride, std::size_t rowStride,
+                bool swapBytes = false)
+        : volume_(volume), view_(first), size_(width * height) {
+        const bool swap = swapBytes && sizeof(T) > 1;
+        if(!swap && columnStride == 1 && (rowStride == width || height == 1))
+            return;
+        copy_.resize(size_);
+        T* out = copy_.data();
+        for(std::size_t r = 0; r != height; ++r) {
+            const T* in = first + r * rowStride;
+            if(columnStride == 1) {
+                out = std::copy(in, in + width, out);
+            } else {
+                for(std::size_t c = 0; c != width; ++c, in += columnStride)
+                    *out++ = *in;
+            }
+        }
+        if(swap) std::transform(copy_.begin(), copy_.end(), copy_.begin(),
+                                ByteSwap< T >);
+        volume_.reset();
+        view_ = nullptr;
+    }
+    ///Frame owning @c buffer, byte swapped in place if @c swapBytes
+    explicit ScalarFrame(std::vector< T >&& buffer, bool swapBytes = false)
+        : size_(buffer.size()), copy_(std::move(buffer)) {
+        if(swapBytes && sizeof(T) > 1)
+            std::transform(copy_.begin(), copy_.end(), copy_.begin(),
+                           ByteSwap< T >);
+    }
+    ScalarFrame(ScalarFrame&& other) { *this = std::move(other); }
+    ScalarFrame& operator=(ScalarFrame&& other) {
+        if(this != &other) {
+            file_ = std::move(other.file_);
+            volume_ = std::move(other.volume_);
+            copy_ = std::move(other.copy_);
+            view_ = other.view_;
+            size_ = other.size_;
+            other.view_ = nullptr;
+            other.size_ = 0;
+            other.copy_.clear();
+        }
+        return *this;
+    }
+    const T* data() const {
+        return copy_.empty() ? view_ : copy_.data();
+    }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size() == 0; }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + size(); }
+    const T* cbegin() const { return begin(); }
+    const T* cend() const { return end(); }
+    const T& operator[](std::size_t i) const { return data()[i]; }
+    ///Owned buffer, for reuse once the frame is not needed anymore; the frame
+    ///is left empty
+    std::vector< T > TakeBuffer() {
+        std::vector< T > b = std::move(copy_);
+        *this = ScalarFrame();
+        return b;
+    }
+    ///Read ahead [begin, end), see MappedFile::Prefetch
+    void Prefetch(const T* begin, const T* end) const {
+        if(!copy_.empty()) return;
+        Mapping().Prefetch(Offset(begin), std::size_t(end - begin) * sizeof(T));
+    }
+    ///Release the memory of [begin, end), see MappedFile::Release
+    void Release(const T* begin, const T* end) const {
+        if(!copy_.empty()) return;
+        Mapping().Release(Offset(begin), std::size_t(end - begin) * sizeof(T));
+    }
+private:
+    const MappedFile& Mapping() const { return volume_ ? *volume_ : file_; }
+    std::size_t Offset(const T* p) const {
+        return std::size_t(reinterpret_cast< const char* >(p)
+                           - Mapping().Data());
+    }
+private:
+    MappedFile file_;
+    ///mapping shared with the other slices of a volume
+    std::shared_ptr< const MappedFile > volume_;
+    const T* view_ = nullptr;
+    std::size_t size_ = 0;
+    std::vector< T > copy_;
+};
+
+//------------------------------------------------------------------------------
+///Layout of a volume or time series of scalars stored in a single raw file:
+///element @c (x, y, z) is at byte offset + (x * stride[0] + y * stride[1]
+///+ z * stride[2]) * element size; the default strides are those of a
+///contiguous array with x varying fastest. The frames are the slices
+///perpendicular to @c axis, images are x by y (axis z), x by z (axis y) or
+///y by z (axis x), the first row being the bottom one as for frame files
+struct VolumeLayout {
+    std::size_t offset = 0;
+    std::size_t extent[3] = {1, 1, 1};
+    std::size_t stride[3] = {0, 0, 0};
+    int axis = 2;
+    ///Default strides for the current extents
+    void ContiguousStrides() {
+        stride[0] = 1;
+        stride[1] = extent[0];
+        stride[2] = extent[0] * extent[1];
+    }
+    ///Image columns and rows axes
+    int ColumnAxis() const { return axis == 0 ? 1 : 0; }
+    int RowAxis() const { return axis == 2 ? 1 : 2; }
+    std::size_t Width() const { return extent[ColumnAxis()]; }
+    std::size_t Height() const { return extent[RowAxis()]; }
+    std::size_t Slices() const { return extent[axis]; }
+    ///Slices are contiguous in the file
+    bool Contiguous() const {
+        return stride[ColumnAxis()] == 1
+               && (stride[RowAxis()] == Width() || Height() == 1);
+    }
+};
+
+///Volume stored in a raw file, mapped once: the slices are views of the
+///mapping, without copies if the slices are contiguous in the file and the
+///byte order is the host one, gathered into the frame otherwise.
+///Slices can be extracted concurrently
+template < typename T >
+class Volume {
+public:
+    Volume() = default;
+    Volume(const std::string& fname, const VolumeLayout& layout,
+           bool swapBytes = false)
+        : layout_(layout), swapBytes_(swapBytes) {
+        if(IsGzipFile(fname))
+            throw std::runtime_error("Compressed volumes not supported");
+        //strided slices touch pages all over the file, the read-ahead of a
+        //sequential hint is wasted
+        file_ = std::make_shared< const MappedFile >(fname,
+                                                     layout.Contiguous());
+        if(layout.offset % alignof(T) != 0)
+            throw std::runtime_error("Volume offset not aligned");
+        std::size_t last = 0;
+        for(int i = 0; i != 3; ++i) {
+            if(layout.extent[i] < 1)
+                throw std::runtime_error("Invalid volume extent");
+            last += (layout.extent[i] - 1) * layout.stride[i];
+        }
+        if(file_->Size() < layout.offset
+           || (file_->Size() - layout.offset) / sizeof(T) <= last)
+            throw std::runtime_error("File smaller than volume");
+    }
+    const VolumeLayout& Layout() const { return layout_; }
+    ///Slice @c i along the layout axis
+    ScalarFrame< T > Slice(std::size_t i) const {
+        if(i >= layout_.Slices())
+            throw std::runtime_error("Slice out of range");
+        const T* first = reinterpret_cast< const T* >(file_->Data()
+                                                      + layout_.offset)
+                         + i * layout_.stride[layout_.axis];
+        return ScalarFrame< T >(file_, first, layout_.Width(),
+                                layout_.Height(),
+                                layout_.stride[layout_.ColumnAxis()],
+                                layout_.stride[layout_.RowAxis()],
+                                swapBytes_);
+    }
+private:
+    std::shared_ptr< const MappedFile > file_;
+    VolumeLayout layout_;
+    bool swapBytes_ = false;
+};
@@ -0,0 +1,162 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+
+#include <zlib.h>
+
+#include "ParallelFor.h"
+
+//Gzip compressed frames: link with -lz
+
+//------------------------------------------------------------------------------
+///Frame files whose name ends with .gz are gzip compressed
+inline bool IsGzipFile(const std::string& fname) {
+    return fname.size() > 3 && fname.compare(fname.size() - 3, 3, ".gz") == 0;
+}
+
+namespace detail {
+///Gzip member of a BGZF file: compressed bytes and uncompressed size
+struct GzipBlock {
+    std::size_t offset;
+    std::size_t size;
+    std::size_t outOffset;
+    std::size_t outSize;
+};
+
+inline std::uint32_t LittleEndian32(const unsigned char* p) {
+    return std::uint32_t(p[0]) | std::uint32_t(p[1]) << 8
+           | std::uint32_t(p[2]) << 16 | std::uint32_t(p[3]) << 24;
+}
+
+///Blocks of BGZF data, the blocked gzip format of bgzip: concatenated gzip
+///members with their compressed size in a "BC" extra field and their
+///uncompressed size in the trailer, such that the blocks can be located
+///without decompressing them. False if the data is not BGZF
+inline bool BGZFBlocks(const unsigned char* in, std::size_t n,
+                       std::vector< GzipBlock >& blocks) {
+    blocks.clear();
+    std::size_t out = 0;
+    for(std::size_t i = 0; i < n;) {
+        //fixed header, FEXTRA set, XLEN
+        if(n - i < 18 || in[i] != 0x1f || in[i + 1] != 0x8b || in[i + 2] != 8
+           || !(in[i + 3] & 4)) return false;
+        const std::size_t xlen = std::size_t(in[i + 10])
+                                 | std::size_t(in[i + 11]) << 8;
+        if(n - i < 12 + xlen) return false;
+        std::size_t bsize = 0;
+        for(std::size_t x = i + 12; x + 4 <= i + 12 + xlen;) {
+            const std::size_t slen = std::size_t(in[x + 2])
+                                     | std::size_t(in[x + 3]) << 8;
+            if(in[x] == 'B' && in[x + 1] == 'C' && slen == 2
+               && x + 6 <= i + 12 + xlen) {
+                bsize = (std::size_t(in[x + 4])
+                         | std::size_t(in[x + 5]) << 8) + 1;
+            }
+            x += 4 + slen;
+        }
+        if(!bsize || bsize < 12 + xlen + 8 || n - i < bsize) return false;
+        const std::size_t isize = LittleEndian32(in + i + bsize - 4);
+        blocks.push_back({i, bsize, out, isize});
+        out += isize;
+        i += bsize;
+    }
+    return !blocks.empty();
+}
+
+///Decompress the gzip member(s) in [in, in + n) into [out, out + outSize),
+///the data must fill the output exactly unless @c grow is not null, in which
+///case @c out is the data of @c grow, which is resized as needed, and the
+///decompressed size in bytes is stored in @c size. Concatenated members are
+///decompressed one after the other
+template < typename T >
+void Inflate(const unsigned char* in, std::size_t n, unsigned char* out,
+             std::size_t outSize, std::vector< T >* grow, std::size_t* size) {
+    z_stream z;
+    std::memset(&z, 0, sizeof(z));
+    if(inflateInit2(&z, 16 + MAX_WBITS) != Z_OK)
+        throw std::runtime_error("Cannot decompress file");
+    std::size_t done = 0;
+    std::size_t consumed = 0;
+    int r = Z_OK;
+    while(consumed < n) {
+        if(grow && done == outSize) {
+            grow->resize(std::max((std::size_t(1) << 16) / sizeof(T) + 1,
+                                  2 * grow->size()));
+            out = reinterpret_cast< unsigned char* >(grow->data());
+            outSize = grow->size() * sizeof(T);
+        }
+        //zlib counts in 32 bit integers
+        const std::size_t inChunk = std::min(n - consumed,
+                                             std::size_t(1) << 30);
+        const std::size_t outChunk = std::min(outSize - done,
+                                              std::size_t(1) << 30);
+        z.next_in = const_cast< unsigned char* >(in + consumed);
+        z.avail_in = uInt(inChunk);
+        z.next_out = out + done;
+        z.avail_out = uInt(outChunk);
+        r = inflate(&z, Z_NO_FLUSH);
+        consumed += inChunk - z.avail_in;
+        done += outChunk - z.avail_out;
+        if(r == Z_STREAM_END) {
+            //next member, if any
+            if(consumed < n) inflateReset(&z);
+            continue;
+        }
+        if(r != Z_OK && !(r == Z_BUF_ERROR && grow && done == outSize)) break;
+    }
+    inflateEnd(&z);
+    if(r != Z_STREAM_END || (!grow && done != outSize))
+        throw std::runtime_error("Cannot decompress file");
+    if(size) *size = done;
+}
+} //namespace detail
+
+//------------------------------------------------------------------------------
+///Decompress the gzip file contents [in, in + n) into @c out, resized to the
+///number of whole elements of type T. BGZF files (bgzip) are decompressed
+///straight into @c out by @c threads threads, one block at a time; other
+///gzip files are decompressed sequentially straight into @c out, sized from
+///the uncompressed size in the trailer of the last member
+template < typename T >
+void Gunzip(const char* in, std::size_t n, std::vector< T >& out,
+            int threads = 1) {
+    const unsigned char* data = reinterpret_cast< const unsigned char* >(in);
+    if(n < 18 || data[0] != 0x1f || data[1] != 0x8b)
+        throw std::runtime_error("Not a gzip file");
+    std::vector< detail::GzipBlock > blocks;
+    if(detail::BGZFBlocks(data, n, blocks)) {
+        const std::size_t size = blocks.back().outOffset
+                                 + blocks.back().outSize;
+        if(size % sizeof(T) != 0)
+            throw std::runtime_error("Decompressed size not a multiple of "
+                                     "the element size");
+        out.resize(size / sizeof(T));
+        unsigned char* o = reinterpret_cast< unsigned char* >(out.data());
+        ParallelFor(blocks.size(), 16, threads,
+                    [&](std::size_t b, std::size_t e) {
+            for(std::size_t i = b; i != e; ++i) {
+                const detail::GzipBlock& k = blocks[i];
+                detail::Inflate< T >(data + k.offset, k.size,
+                                     o + k.outOffset, k.outSize, nullptr,
+                                     nullptr);
+            }
+        });
+        return;
+    }
+    //the trailer holds the size modulo 4 GiB of the last member only: the
+    //output grows if the data turns out to be larger
+    const std::size_t isize = detail::LittleEndian32(data + n - 4);
+    out.resize(std::max((isize + sizeof(T) - 1) / sizeof(T), std::size_t(1)));
+    std::size_t size = 0;
+    detail::Inflate(data, n, reinterpret_cast< unsigned char* >(out.data()),
+                    out.size() * sizeof(T), &out, &size);
+    if(size % sizeof(T) != 0)
+        throw std::runtime_error("Decompressed size not a multiple of "
+                                 "the element size");
+    out.resize(size / sizeof(T));
+}
@@ -15,7 +15,9 @@ LinearInterpolation(const std::vector< Vector3D< ScalarT > >& points,
     if(std::abs(t) < 10E-8) t = ScalarT(0);
     assert(points.size() == keys.size());
     assert(maxVal >= minVal);
-    t = (t - minVal) / (maxVal - minVal);
+    t = maxVal > minVal ? (t - minVal) / (maxVal - minVal) : ScalarT(0);
+    if(!(t > keys.front())) t = keys.front();
+    if(t > keys.back()) t = keys.back();
     using K = std::vector< ScalarT >;
     typename K::const_iterator i = 
                                   std::lower_bound(keys.begin(), keys.end(), t);
@@ -30,7 +32,7 @@ LinearInterpolation(const std::vector< Vector3D< ScalarT > >& points,
     const std::size_t pidx1 = std::min(points.size() - 1, pidx0 + 1);
     const V& p0 = points[pidx0];
     const V& p1 = points[pidx1];
-    return p0 * (ScalarT(1) - t) + p1 * t; 
+    return p0 * (ScalarT(1) - u) + p1 * u; 
 }
 
 template < typename ScalarT >
@@ -0,0 +1,156 @@
+#pragma once
+#include <cstddef>
+#include <limits>
+#include <mutex>
+
+#include "ParallelFor.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SCOLOR_X86_SIMD
+//GCC 12 headers build the undefined vectors of the unmasked AVX-512
+//intrinsics from self-initialized variables, a -Wmaybe-uninitialized false
+//positive wherever they are inlined (fixed in GCC 13)
+#ifndef __clang__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+#ifndef __clang__
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+//------------------------------------------------------------------------------
+///Range of the values in an array and number of values it was computed from.
+///NaNs are never counted; with skipNonFinite infinities are not counted
+///either. min > max if no value was counted.
+template < typename T >
+struct ScalarRange {
+    T min = Highest();
+    T max = Lowest();
+    std::size_t count = 0;
+    void Merge(const ScalarRange& r) {
+        if(r.min < min) min = r.min;
+        if(r.max > max) max = r.max;
+        count += r.count;
+    }
+    static T Highest() {
+        return std::numeric_limits< T >::has_infinity ?
+               std::numeric_limits< T >::infinity()
+               : std::numeric_limits< T >::max();
+    }
+    static T Lowest() {
+        return std::numeric_limits< T >::has_infinity ?
+               -std::numeric_limits< T >::infinity()
+               : std::numeric_limits< T >::lowest();
+    }
+};
+
+namespace detail {
+template < typename T >
+bool IsFinite(T v) {
+    //false for NaN and infinities, always true for integers
+    return v - v == T(0);
+}
+
+template < typename T >
+ScalarRange< T > MinMaxScalar(const T* in, std::size_t n, bool skipNonFinite) {
+    ScalarRange< T > r;
+    for(std::size_t i = 0; i != n; ++i) {
+        const T v = in[i];
+        if(v != v || (skipNonFinite && !IsFinite(v))) continue;
+        if(v < r.min) r.min = v;
+        if(v > r.max) r.max = v;
+        ++r.count;
+    }
+    return r;
+}
+
+#ifdef SCOLOR_X86_SIMD
+///Four independent accumulators of four lanes, NaNs never compare and are
+///left out by min/max which return the second operand for unordered values
+__attribute__((target("avx2")))
+inline ScalarRange< double > MinMaxAVX2(const double* in, std::size_t n,
+                                        bool skipNonFinite, std::size_t& done) {
+    const std::size_t nv = n - n % 16;
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d pinf = _mm256_set1_pd(ScalarRange< double >::Highest());
+    const __m256d ninf = _mm256_set1_pd(ScalarRange< double >::Lowest());
+    __m256d m[4] = {pinf, pinf, pinf, pinf};
+    __m256d M[4] = {ninf, ninf, ninf, ninf};
+    __m256d c[4] = {zero, zero, zero, zero};
+    for(std::size_t i = 0; i != nv; i += 16) {
+        for(int k = 0; k != 4; ++k) {
+            const __m256d x = _mm256_loadu_pd(in + i + 4 * k);
+            __m256d valid;
+            if(skipNonFinite) {
+                valid = _mm256_cmp_pd(_mm256_sub_pd(x, x), zero, _CMP_EQ_OQ);
+                m[k] = _mm256_min_pd(_mm256_blendv_pd(pinf, x, valid), m[k]);
+                M[k] = _mm256_max_pd(_mm256_blendv_pd(ninf, x, valid), M[k]);
+            } else {
+                valid = _mm256_cmp_pd(x, x, _CMP_ORD_Q);
+                m[k] = _mm256_min_pd(x, m[k]);
+                M[k] = _mm256_max_pd(x, M[k]);
+            }
+            c[k] = _mm256_add_pd(c[k], _mm256_and_pd(valid, one));
+        }
+    }
+    m[0] = _mm256_min_pd(_mm256_min_pd(m[0], m[1]), _mm256_min_pd(m[2], m[3]));
+    M[0] = _mm256_max_pd(_mm256_max_pd(M[0], M[1]), _mm256_max_pd(M[2], M[3]));
+    c[0] = _mm256_add_pd(_mm256_add_pd(c[0], c[1]), _mm256_add_pd(c[2], c[3]));
+    double lm[4], lM[4], lc[4];
+    _mm256_storeu_pd(lm, m[0]);
+    _mm256_storeu_pd(lM, M[0]);
+    _mm256_storeu_pd(lc, c[0]);
+    ScalarRange< double > r;
+    for(int l = 0; l != 4; ++l) {
+        if(lm[l] < r.min) r.min = lm[l];
+        if(lM[l] > r.max) r.max = lM[l];
+        r.count += std::size_t(lc[l]);
+    }
+    done = nv;
+    return r;
+}
+#endif
+
+template < typename T >
+ScalarRange< T > MinMax(const T* in, std::size_t n, bool skipNonFinite) {
+    return MinMaxScalar(in, n, skipNonFinite);
+}
+
+inline ScalarRange< double > MinMax(const double* in, std::size_t n,
+                                    bool skipNonFinite) {
+    std::size_t done = 0;
+    ScalarRange< double > r;
+#ifdef SCOLOR_X86_SIMD
+    if(__builtin_cpu_supports("avx2"))
+        r = MinMaxAVX2(in, n, skipNonFinite, done);
+#endif
+    r.Merge(MinMaxScalar(in + done, n - done, skipNonFinite));
+    return r;
+}
+} //namespace detail
+
+//------------------------------------------------------------------------------
+///Minimum, maximum and number of values of [begin, end) computed in a single
+///pass, split across @c threads threads. NaNs are ignored, with
+///@c skipNonFinite infinities are ignored as well.
+///When [begin, end) is a fresh memory mapping this is the pass that faults
+///the data in, min and max are computed while the data streams in.
+template < typename T >
+ScalarRange< T > MinMax(const T* begin, const T* end, int threads = 1,
+                        bool skipNonFinite = false) {
+    //blocks of 1M elements
+    const std::size_t blockSize = 1 << 20;
+    ScalarRange< T > r;
+    std::mutex mutex;
+    ParallelFor(std::size_t(end - begin), blockSize, threads,
+                [&](std::size_t b, std::size_t e) {
+                    const ScalarRange< T > p =
+                        detail::MinMax(begin + b, e - b, skipNonFinite);
+                    std::lock_guard< std::mutex > lock(mutex);
+                    r.Merge(p);
+                });
+    return r;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+///Split [0, n) into chunks of @c chunkSize elements and process them with
+///@c threads workers (the calling thread included), each worker pulls the
+///next unprocessed chunk from a shared counter so that faster workers take
+///over more chunks.
+///f(begin, end) is called once per chunk. The first exception thrown is
+///rethrown after all the workers complete.
+template < typename F >
+void ParallelFor(std::size_t n, std::size_t chunkSize, int threads, F f) {
+    if(n == 0) return;
+    if(chunkSize == 0) chunkSize = 1;
+    const std::size_t chunks = (n + chunkSize - 1) / chunkSize;
+    if(threads < 2 || chunks < 2) {
+        f(std::size_t(0), n);
+        return;
+    }
+    const int workers = int(std::min(std::size_t(threads), chunks));
+    std::atomic< std::size_t > next(0);
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    auto work = [&]() {
+        try {
+            for(std::size_t c = next++; c < chunks; c = next++) {
+                const std::size_t b = c * chunkSize;
+                f(b, std::min(n, b + chunkSize));
+            }
+        } catch(...) {
+            next = chunks;
+            std::lock_guard< std::mutex > lock(errorMutex);
+            if(!error) error = std::current_exception();
+        }
+    };
+    std::vector< std::thread > pool;
+    pool.reserve(workers - 1);
+    for(int i = 1; i < workers; ++i) pool.push_back(std::thread(work));
+    work();
+    for(auto& t: pool) t.join();
+    if(error) std::rethrow_exception(error);
+}
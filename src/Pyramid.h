@@ -0,0 +1,229 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cerrno>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <limits>
+#include <algorithm>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ParallelFor.h"
+
+//------------------------------------------------------------------------------
+///Multi-resolution tiled output of a frame: each level halves the size of
+///the next one, the last level is the full resolution frame. Levels are
+///computed in scalar space, before colorization, so that the aggregates
+///(mean or max) are those of the data and not of the colors.
+///Images are stored bottom-up as the input frames: the first row in memory
+///is the bottom row of the image; tiles are numbered from the top left.
+struct PyramidOptions {
+    enum Scheme {DEEP_ZOOM, XYZ};
+    enum Aggregate {MEAN, MAX};
+    Scheme scheme = DEEP_ZOOM;
+    Aggregate aggregate = MEAN;
+    int tileSize = 256;
+};
+
+//------------------------------------------------------------------------------
+///Halve a bottom-up image: each output pixel aggregates the 2x2 block of
+///input pixels starting at the top left corner of the image, blocks are
+///cropped on the right and bottom edges of odd sized images. NaNs are left
+///out, the aggregate of all NaN blocks is NaN.
+///The output holds ((width + 1) / 2) * ((height + 1) / 2) elements.
+template < typename T >
+void Downsample2(const T* in, int width, int height,
+                 std::vector< double >& out,
+                 PyramidOptions::Aggregate aggregate, int threads = 1) {
+    const int w = (width + 1) / 2;
+    const int h = (height + 1) / 2;
+    out.resize(std::size_t(w) * h);
+    const double nan = std::numeric_limits< double >::quiet_NaN();
+    ParallelFor(std::size_t(h), 64, threads,
+                [&](std::size_t b, std::size_t e) {
+        for(int r = int(b); r != int(e); ++r) {
+            //top-down image rows 2r and 2r + 1
+            const T* row0 = in + std::size_t(height - 1 - 2 * r) * width;
+            const T* row1 = 2 * r + 1 < height ? row0 - width : nullptr;
+            double* o = out.data() + std::size_t(h - 1 - r) * w;
+            for(int x = 0; x != w; ++x) {
+                const int x0 = 2 * x;
+                const int n = x0 + 1 < width ? 2 : 1;
+                double acc = aggregate == PyramidOptions::MAX ?
+                             -std::numeric_limits< double >::infinity() : 0.0;
+                int count = 0;
+                for(int i = 0; i != n; ++i) {
+                    const double v[2] = {double(row0[x0 + i]),
+                                         row1 ? double(row1[x0 + i]) : nan};
+                    for(double u: v) {
+                        if(u != u) continue;
+                        acc = aggregate == PyramidOptions::MAX ?
+                              (u > acc ? u : acc) : acc + u;
+                        ++count;
+                    }
+                }
+                o[x] = !count ? nan
+                       : aggregate == PyramidOptions::MAX ? acc
+                       : acc / count;
+            }
+        }
+    });
+}
+
+//------------------------------------------------------------------------------
+///Level sizes, tile grid and file names of a pyramid.
+///DeepZoom: <base>.dzi descriptor and <base>_files/<level>/<column>_<row>.ext,
+///levels go down to a single pixel, edge tiles are cropped.
+///XYZ: <base>/<z>/<x>/<y>.ext, zoom 0 is a single tile, edge tiles are
+///padded to the full tile size.
+class TileLayout {
+public:
+    TileLayout(PyramidOptions::Scheme scheme, const std::string& base,
+               int width, int height, int tileSize,
+               const std::string& extension)
+        : scheme_(scheme), base_(base), width_(width), height_(height),
+          tileSize_(tileSize), extension_(extension) {
+        if(tileSize < 1) throw std::logic_error("Invalid tile size");
+        int levels = 1;
+        if(scheme == PyramidOptions::DEEP_ZOOM) {
+            while(((std::max(width, height) - 1) >> (levels - 1)) > 0)
+                ++levels;
+        } else {
+            while(((std::max(width, height) - 1) >> (levels - 1)) >= tileSize)
+                ++levels;
+        }
+        levels_ = levels;
+    }
+    int Levels() const { return levels_; }
+    ///Size of level @c l, Levels() - 1 is the full resolution
+    int Width(int l) const { return Scaled(width_, l); }
+    int Height(int l) const { return Scaled(height_, l); }
+    int Columns(int l) const { return (Width(l) + tileSize_ - 1) / tileSize_; }
+    int Rows(int l) const { return (Height(l) + tileSize_ - 1) / tileSize_; }
+    int TileSize() const { return tileSize_; }
+    bool PadTiles() const { return scheme_ == PyramidOptions::XYZ; }
+    std::string TilePath(int l, int column, int row) const {
+        std::ostringstream os;
+        if(scheme_ == PyramidOptions::DEEP_ZOOM) {
+            os << base_ << "_files/" << l << '/' << column << '_' << row;
+        } else {
+            os << base_ << '/' << l << '/' << column << '/' << row;
+        }
+        os << '.' << extension_;
+        return os.str();
+    }
+    ///Create the directories of the tiles of level @c l
+    void CreateDirectories(int l) const {
+        if(scheme_ == PyramidOptions::DEEP_ZOOM) {
+            MakeDirectory(base_ + "_files");
+            MakeDirectory(base_ + "_files/" + std::to_string(l));
+        } else {
+            MakeDirectory(base_);
+            const std::string z = base_ + '/' + std::to_string(l);
+            MakeDirectory(z);
+            for(int c = 0; c != Columns(l); ++c)
+                MakeDirectory(z + '/' + std::to_string(c));
+        }
+    }
+    ///DeepZoom descriptor or, for XYZ, a JSON file with the image size
+    void WriteDescriptor() const {
+        if(scheme_ == PyramidOptions::DEEP_ZOOM) {
+            std::ofstream os(base_ + ".dzi");
+            if(!os) throw std::runtime_error("Cannot write to file");
+            os << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+               << "<Image xmlns=\"http://schemas.microsoft.com/deepzoom/2008\""
+               << " TileSize=\"" << tileSize_ << "\" Overlap=\"0\""
+               << " Format=\"" << extension_ << "\">\n"
+               << "  <Size Width=\"" << width_ << "\" Height=\"" << height_
+               << "\"/>\n</Image>\n";
+        } else {
+            std::ofstream os(base_ + "/tiles.json");
+            if(!os) throw std::runtime_error("Cannot write to file");
+            os << "{\"width\": " << width_ << ", \"height\": " << height_
+               << ", \"tile_size\": " << tileSize_
+               << ", \"min_zoom\": 0, \"max_zoom\": " << levels_ - 1
+               << ", \"format\": \"" << extension_ << "\"}\n";
+        }
+    }
+    ///File storing the hashes of the tiles, see TileIndex
+    std::string IndexPath() const {
+        return scheme_ == PyramidOptions::DEEP_ZOOM ? base_ + "_files/tiles.idx"
+                                                    : base_ + "/tiles.idx";
+    }
+private:
+    int Scaled(int size, int l) const {
+        const int shift = levels_ - 1 - l;
+        return std::max(1, (size + (1 << shift) - 1) >> shift);
+    }
+    static void MakeDirectory(const std::string& path) {
+        if(mkdir(path.c_str(), 0755) != 0 && errno != EEXIST)
+            throw std::runtime_error("Cannot create directory " + path);
+    }
+private:
+    PyramidOptions::Scheme scheme_;
+    std::string base_;
+    int width_;
+    int height_;
+    int tileSize_;
+    std::string extension_;
+    int levels_;
+};
+
+//------------------------------------------------------------------------------
+///64 bit FNV-1a hash, @c h is the hash of the preceding data
+inline std::uint64_t FNV1a(const void* data, std::size_t size,
+                           std::uint64_t h = 14695981039346656037ull) {
+    const unsigned char* p = static_cast< const unsigned char* >(data);
+    for(std::size_t i = 0; i != size; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+///Hashes of the scalar data and rendering parameters of the tiles written
+///by a previous run: tiles whose hash did not change and whose file exists
+///are not colorized and encoded again. Text file, one
+///"level column row hash" line per tile.
+class TileIndex {
+public:
+    explicit TileIndex(const std::string& path) : path_(path) {
+        std::ifstream is(path);
+        int l, c, r;
+        std::uint64_t h;
+        while(is >> l >> c >> r >> h) hashes_[Key(l, c, r)] = h;
+    }
+    bool Unchanged(int l, int c, int r, std::uint64_t h,
+                   const std::string& tilePath) const {
+        auto i = hashes_.find(Key(l, c, r));
+        return i != hashes_.end() && i->second == h
+               && access(tilePath.c_str(), F_OK) == 0;
+    }
+    ///Not thread safe
+    void Set(int l, int c, int r, std::uint64_t h) { hashes_[Key(l, c, r)] = h; }
+    void Save() const {
+        std::ofstream os(path_);
+        if(!os) throw std::runtime_error("Cannot write to file");
+        for(auto& i: hashes_) {
+            os << (i.first >> 48) << ' ' << ((i.first >> 24) & 0xFFFFFF)
+               << ' ' << (i.first & 0xFFFFFF) << ' ' << i.second << '\n';
+        }
+    }
+private:
+    static std::uint64_t Key(int l, int c, int r) {
+        return (std::uint64_t(l) << 48) | (std::uint64_t(c) << 24)
+               | std::uint64_t(r);
+    }
+private:
+    std::string path_;
+    std::unordered_map< std::uint64_t, std::uint64_t > hashes_;
+};
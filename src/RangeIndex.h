@@ -0,0 +1,201 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MinMax.h"
+
+//------------------------------------------------------------------------------
+///Size and modification time of a file, changes whenever the file is
+///rewritten
+struct FileKey {
+    std::uint64_t size = 0;
+    ///nanoseconds since the epoch
+    std::int64_t mtime = 0;
+    static FileKey Of(const std::string& fname) {
+        struct stat st;
+        if(::stat(fname.c_str(), &st) != 0)
+            throw std::runtime_error("Cannot read from file");
+        FileKey k;
+        k.size = std::uint64_t(st.st_size);
+        k.mtime = std::int64_t(st.st_mtim.tv_sec) * 1000000000
+                  + std::int64_t(st.st_mtim.tv_nsec);
+        return k;
+    }
+    bool operator==(const FileKey& k) const {
+        return size == k.size && mtime == k.mtime;
+    }
+    bool operator!=(const FileKey& k) const { return !(*this == k); }
+};
+
+//------------------------------------------------------------------------------
+///Data ranges of the frames of a sequence and percentiles of the whole
+///sequence persisted in a sidecar text file, so that rendering a sequence
+///again skips the range pass. Frame entries are keyed by a name that
+///identifies the frame and its interpretation (file, element type, slice)
+///and are valid as long as the size and modification time of the file
+///match; percentile entries are keyed by a hash of the names and file keys
+///of all the frames they were computed from. Lines:
+///  frame <size> <mtime> <count> <min> <max> <name>
+///  pct <hash> <percentile> <value>
+class RangeIndex {
+public:
+    explicit RangeIndex(const std::string& path) : path_(path) {
+        std::ifstream is(path);
+        std::string line;
+        while(std::getline(is, line)) {
+            std::istringstream ls(line);
+            std::string kind;
+            ls >> kind;
+            if(kind == "frame") {
+                Frame f;
+                if(!(ls >> f.key.size >> f.key.mtime >> f.range.count
+                        >> f.range.min >> f.range.max)) continue;
+                ls.ignore(1);
+                std::string name;
+                std::getline(ls, name);
+                if(!name.empty()) frames_[name] = f;
+            } else if(kind == "pct") {
+                std::uint64_t h;
+                double p, v;
+                if(ls >> h >> p >> v) percentiles_[std::make_pair(h, p)] = v;
+            }
+        }
+    }
+    ///Range of frame @c name if cached and @c key matches
+    bool Get(const std::string& name, const FileKey& key,
+             ScalarRange< double >& r) const {
+        std::lock_guard< std::mutex > lock(mutex_);
+        auto i = frames_.find(name);
+        if(i == frames_.end() || i->second.key != key) return false;
+        r = i->second.range;
+        return true;
+    }
+    ///Thread safe
+    void Set(const std::string& name, const FileKey& key,
+             const ScalarRange< double >& r) {
+        std::lock_guard< std::mutex > lock(mutex_);
+        Frame& f = frames_[name];
+        if(f.key != key || f.range.count != r.count || f.range.min != r.min
+           || f.range.max != r.max) modified_ = true;
+        f.key = key;
+        f.range = r;
+    }
+    ///Percentile @c p of the frames whose names and keys hash to @c h
+    bool GetPercentile(std::uint64_t h, double p, double& v) const {
+        std::lock_guard< std::mutex > lock(mutex_);
+        auto i = percentiles_.find(std::make_pair(h, p));
+        if(i == percentiles_.end()) return false;
+        v = i->second;
+        return true;
+    }
+    void SetPercentile(std::uint64_t h, double p, double v) {
+        std::lock_guard< std::mutex > lock(mutex_);
+        percentiles_[std::make_pair(h, p)] = v;
+        modified_ = true;
+    }
+    ///Write the index if modified: to a temporary file renamed over the
+    ///index, readers never see a partially written index
+    void Save() const {
+        if(!modified_) return;
+        //unique across processes and the jobs of a -serve process
+        static std::atomic< unsigned > count(0);
+        const std::string tmp = path_ + '.' + std::to_string(::getpid())
+                                + '.' + std::to_string(count++) + ".tmp";
+        std::ofstream os(tmp);
+        if(!os) throw std::runtime_error("Cannot write to file");
+        os.precision(17);
+        for(auto& i: frames_) {
+            const Frame& f = i.second;
+            os << "frame " << f.key.size << ' ' << f.key.mtime << ' '
+               << f.range.count << ' ' << f.range.min << ' ' << f.range.max
+               << ' ' << i.first << '\n';
+        }
+        for(auto& i: percentiles_) {
+            os << "pct " << i.first.first << ' ' << i.first.second << ' '
+               << i.second << '\n';
+        }
+        os.close();
+        if(!os || std::rename(tmp.c_str(), path_.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            throw std::runtime_error("Cannot write to file");
+        }
+    }
+private:
+    struct Frame {
+        FileKey key;
+        ScalarRange< double > range;
+    };
+    struct PairHash {
+        std::size_t operator()(const std::pair< std::uint64_t, double >& k)
+            const {
+            return std::hash< std::uint64_t >()(k.first)
+                   ^ (std::hash< double >()(k.second) * 31);
+        }
+    };
+private:
+    std::string path_;
+    std::unordered_map< std::string, Frame > frames_;
+    std::unordered_map< std::pair< std::uint64_t, double >, double,
+                        PairHash > percentiles_;
+    bool modified_ = false;
+    mutable std::mutex mutex_;
+};
+
+//------------------------------------------------------------------------------
+///Percentile @c p in [0, 100] of the values counted in @c histogram, whose
+///bins evenly cover [minVal, maxVal]: same rank as Percentile on the sorted
+///values, with the values of each bin assumed evenly spread within the bin;
+///the result is in the bin of the value of that rank
+inline double HistogramPercentile(const std::vector< std::size_t >& histogram,
+                                  double minVal, double maxVal, double p) {
+    std::size_t n = 0;
+    for(std::size_t c: histogram) n += c;
+    if(!n || p <= 0.0) return minVal;
+    if(p >= 100.0) return maxVal;
+    const double rank = p / 100.0 * double(n - 1);
+    const double width = (maxVal - minVal) / double(histogram.size());
+    std::size_t before = 0;
+    for(std::size_t b = 0; b != histogram.size(); ++b) {
+        if(double(before + histogram[b]) > rank) {
+            const double x = (rank - double(before) + 0.5)
+                             / double(histogram[b]);
+            return std::min(maxVal, minVal + (double(b) + x) * width);
+        }
+        before += histogram[b];
+    }
+    return maxVal;
+}
+
+///Add the values in [begin, end) to @c histogram, whose bins evenly cover
+///[minVal, maxVal]; NaNs and infinities are skipped, values out of the range
+///are counted in the end bins
+template < typename T >
+void AddToHistogram(const T* begin, const T* end, double minVal,
+                    double maxVal, std::vector< std::size_t >& histogram) {
+    const std::size_t bins = histogram.size();
+    const double scale = maxVal > minVal ? double(bins) / (maxVal - minVal)
+                                         : 0.0;
+    for(; begin != end; ++begin) {
+        const double v = double(*begin);
+        if(v - v != 0.0) continue;
+        const double x = (v - minVal) * scale;
+        const std::size_t b = x > 0.0 ? std::size_t(std::min(x, double(bins)))
+                                      : 0;
+        ++histogram[std::min(b, bins - 1)];
+    }
+}
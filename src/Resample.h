@@ -0,0 +1,186 @@
+#pragma once
+#include <cstddef>
+#include <cmath>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+#include "ParallelFor.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SCOLOR_X86_SIMD
+//GCC 12 -Wmaybe-uninitialized false positives, see MinMax.h
+#ifndef __clang__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+#ifndef __clang__
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+//------------------------------------------------------------------------------
+///Resampling of a frame to a different size in scalar space, before
+///colorization, so that colorization and encoding work on the output size.
+///Filters:
+/// - BOX: mean of the input pixels whose center falls into the output pixel
+/// - BILINEAR: linear interpolation at the output pixel center; aliases when
+///   shrinking by more than 2, use BOX
+/// - MAX: maximum of the same pixels as BOX, keeps isolated peaks visible
+///NaNs are left out, output pixels with no valid input are NaN.
+struct ResampleOptions {
+    enum Filter {BOX, BILINEAR, MAX};
+    int width = 0;
+    int height = 0;
+    Filter filter = BOX;
+};
+
+namespace detail {
+///Input pixels of each output pixel along one axis: [first[i], last[i]) and,
+///for bilinear, pixels first[i], first[i] + 1 weighted 1 - t[i], t[i]
+struct ResampleAxis {
+    std::vector< int > first;
+    std::vector< int > last;
+    std::vector< double > t;
+    ResampleAxis(int in, int out, ResampleOptions::Filter filter)
+        : first(out), last(out),
+          t(filter == ResampleOptions::BILINEAR ? out : 0, 0.0) {
+        const double s = double(in) / double(out);
+        for(int i = 0; i != out; ++i) {
+            if(filter == ResampleOptions::BILINEAR) {
+                const double u = std::min(std::max((i + 0.5) * s - 0.5, 0.0),
+                                          double(in - 1));
+                first[i] = std::min(int(u), in - 1);
+                last[i] = std::min(first[i] + 2, in);
+                t[i] = u - first[i];
+            } else {
+                int b = int(std::ceil(i * s - 0.5));
+                int e = std::min(int(std::ceil((i + 1) * s - 0.5)), in);
+                //upsampling: nearest pixel
+                if(e <= b) {
+                    b = std::min(int((i + 0.5) * s), in - 1);
+                    e = b + 1;
+                }
+                first[i] = b;
+                last[i] = e;
+            }
+        }
+    }
+    ///Weight of input pixel @c k for output pixel @c i
+    double Weight(int i, int k) const {
+        return t.empty() || last[i] - first[i] != 2 ? 1.0
+               : k == first[i] ? 1.0 - t[i] : t[i];
+    }
+};
+
+///sum[i] += w * row[i], weight[i] += w for non-NaN values; with @c max
+///sum holds the maximum instead
+template < typename T >
+void AccumulateRow(const T* row, std::size_t n, double w, bool max,
+                   double* sum, double* weight) {
+    for(std::size_t i = 0; i != n; ++i) {
+        const double v = double(row[i]);
+        if(v != v) continue;
+        sum[i] = max ? (weight[i] == 0.0 || v > sum[i] ? v : sum[i])
+                     : sum[i] + w * v;
+        weight[i] += w;
+    }
+}
+
+#ifdef SCOLOR_X86_SIMD
+__attribute__((target("avx2")))
+inline std::size_t AccumulateRowAVX2(const double* row, std::size_t n,
+                                     double w, bool max,
+                                     double* sum, double* weight) {
+    const std::size_t nv = n - n % 4;
+    const __m256d vw = _mm256_set1_pd(w);
+    const __m256d zero = _mm256_setzero_pd();
+    for(std::size_t i = 0; i != nv; i += 4) {
+        const __m256d x = _mm256_loadu_pd(row + i);
+        const __m256d valid = _mm256_cmp_pd(x, x, _CMP_ORD_Q);
+        const __m256d s = _mm256_loadu_pd(sum + i);
+        const __m256d c = _mm256_loadu_pd(weight + i);
+        __m256d r;
+        if(max) {
+            //first valid value or larger value
+            const __m256d take = _mm256_and_pd(valid,
+                _mm256_or_pd(_mm256_cmp_pd(c, zero, _CMP_EQ_OQ),
+                             _mm256_cmp_pd(x, s, _CMP_GT_OQ)));
+            r = _mm256_blendv_pd(s, x, take);
+        } else {
+            r = _mm256_add_pd(s, _mm256_and_pd(valid, _mm256_mul_pd(vw, x)));
+        }
+        _mm256_storeu_pd(sum + i, r);
+        _mm256_storeu_pd(weight + i, _mm256_add_pd(c, _mm256_and_pd(valid, vw)));
+    }
+    return nv;
+}
+#endif
+
+template < typename T >
+void AccumulateRowSIMD(const T* row, std::size_t n, double w, bool max,
+                       double* sum, double* weight) {
+    AccumulateRow(row, n, w, max, sum, weight);
+}
+
+inline void AccumulateRowSIMD(const double* row, std::size_t n, double w,
+                              bool max, double* sum, double* weight) {
+    std::size_t done = 0;
+#ifdef SCOLOR_X86_SIMD
+    if(__builtin_cpu_supports("avx2"))
+        done = AccumulateRowAVX2(row, n, w, max, sum, weight);
+#endif
+    AccumulateRow(row + done, n - done, w, max, sum + done, weight + done);
+}
+} //namespace detail
+
+//------------------------------------------------------------------------------
+///Resample the bottom-up @c inWidth x @c inHeight image @c in to
+///o.width x o.height elements stored into @c out, in parallel over the
+///output rows. Separable: input rows are first combined into one row per
+///output row, the hot loop, vectorized for double data, then columns are
+///combined. Output rows are mapped from the top of the image as in
+///Downsample2.
+template < typename T >
+void Resample(const T* in, int inWidth, int inHeight,
+              const ResampleOptions& o, std::vector< double >& out,
+              int threads = 1) {
+    if(o.width < 1 || o.height < 1 || inWidth < 1 || inHeight < 1)
+        throw std::logic_error("Invalid resample size");
+    const detail::ResampleAxis columns(inWidth, o.width, o.filter);
+    const detail::ResampleAxis rows(inHeight, o.height, o.filter);
+    const bool max = o.filter == ResampleOptions::MAX;
+    const double nan = std::numeric_limits< double >::quiet_NaN();
+    out.resize(std::size_t(o.width) * o.height);
+    ParallelFor(std::size_t(o.height), 16, threads,
+                [&](std::size_t b, std::size_t e) {
+        std::vector< double > sum(inWidth);
+        std::vector< double > weight(inWidth);
+        for(int r = int(b); r != int(e); ++r) {
+            std::fill(sum.begin(), sum.end(), 0.0);
+            std::fill(weight.begin(), weight.end(), 0.0);
+            for(int k = rows.first[r]; k != rows.last[r]; ++k) {
+                //top-down row k
+                const T* row = in + std::size_t(inHeight - 1 - k) * inWidth;
+                detail::AccumulateRowSIMD(row, std::size_t(inWidth),
+                                          rows.Weight(r, k), max,
+                                          sum.data(), weight.data());
+            }
+            double* orow = out.data() + std::size_t(o.height - 1 - r) * o.width;
+            for(int x = 0; x != o.width; ++x) {
+                double s = max ? -std::numeric_limits< double >::infinity()
+                               : 0.0;
+                double w = 0.0;
+                for(int k = columns.first[x]; k != columns.last[x]; ++k) {
+                    if(weight[k] == 0.0) continue;
+                    const double cw = columns.Weight(x, k);
+                    s = max ? std::max(s, sum[k]) : s + cw * sum[k];
+                    w += max ? 1.0 : cw * weight[k];
+                }
+                orow[x] = w == 0.0 ? nan : max ? s : s / w;
+            }
+        }
+    });
+}
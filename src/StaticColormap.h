@@ -0,0 +1,360 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <limits>
+#include <cassert>
+
+#include "Vector3D.h"
+#include "ColormapKernel.h"
+
+//------------------------------------------------------------------------------
+///Colormaps built into the executable: colors and keys are constexpr tables
+///generated by mapgen from maps/builtin.txt into BuiltinMaps.h, each map is a
+///traits type:
+///
+///  struct Name {
+///      enum {SIZE = <number of colors>, HSV = 0 | 1};
+///      static const char* Id();
+///      static const double* Colors(); //SIZE r, g, b triplets in [0, 1]
+///      static const double* Keys();   //SIZE keys in [0, 1]
+///  };
+///
+///StaticColormapKernel evaluates a map with the number of segments known at
+///compile time: the segment search is unrolled, the linear kernel has no
+///cubic terms and the coefficient tables have a fixed size. The SIMD paths
+///count the keys <= t for up to ColormapKernel::LINEAR_SEARCH_SIZE segments;
+///above, AVX-512 uses an unrolled binary search with gathers and AVX2 one
+///unrolled scalar search per lane, where ColormapKernel falls back to scalar
+///code. Same results as ColormapKernel, whose segment
+///coefficients, hsv2rgb and SIMD helpers it shares.
+
+namespace detail {
+///Smallest l such that 2^l >= N
+template < std::size_t N >
+struct Log2Ceil {
+    enum {value = 1 + Log2Ceil< (N + 1) / 2 >::value};
+};
+template <>
+struct Log2Ceil< 1 > {
+    enum {value = 0};
+};
+
+///Branchless binary search unrolled at compile time: index of the segment
+///containing t given the sorted interior keys padded with +inf
+template < std::size_t STEP >
+struct UnrolledSearch {
+    static std::size_t Apply(const double* keys, double t, std::size_t s) {
+        s += keys[s + STEP - 1] <= t ? STEP : 0;
+        return UnrolledSearch< STEP / 2 >::Apply(keys, t, s);
+    }
+#ifdef SCOLOR_X86_SIMD
+    ///Eight lanes, keys loaded through gathers
+    __attribute__((target("avx512f,avx2")))
+    static __m256i Apply(const double* keys, __m512d t, __m256i s) {
+        const __m512d k = _mm512_i32gather_pd(
+                              _mm256_add_epi32(s, _mm256_set1_epi32(STEP - 1)),
+                              keys, 8);
+        const __mmask8 le = _mm512_cmp_pd_mask(k, t, _CMP_LE_OQ);
+        s = _mm512_castsi512_si256(
+                _mm512_mask_add_epi32(_mm512_zextsi256_si512(s), le,
+                                      _mm512_zextsi256_si512(s),
+                                      _mm512_set1_epi32(STEP)));
+        return UnrolledSearch< STEP / 2 >::Apply(keys, t, s);
+    }
+#endif
+};
+template <>
+struct UnrolledSearch< 0 > {
+    static std::size_t Apply(const double*, double, std::size_t s) {
+        return s;
+    }
+#ifdef SCOLOR_X86_SIMD
+    __attribute__((target("avx512f,avx2")))
+    static __m256i Apply(const double*, __m512d, __m256i s) { return s; }
+#endif
+};
+
+#ifdef SCOLOR_X86_SIMD
+///Count of the first N keys <= t in each lane, unrolled at compile time
+template < std::size_t N >
+struct UnrolledCount {
+    __attribute__((target("avx2")))
+    static __m256d Apply(const double* keys, __m256d t, __m256d count) {
+        const __m256d le = _mm256_cmp_pd(_mm256_set1_pd(keys[N - 1]), t,
+                                         _CMP_LE_OQ);
+        return UnrolledCount< N - 1 >::Apply(keys, t,
+                   _mm256_add_pd(count, _mm256_and_pd(le,
+                                                      _mm256_set1_pd(1.0))));
+    }
+    __attribute__((target("avx512f,avx2")))
+    static __m512i Apply(const double* keys, __m512d t, __m512i count) {
+        const __mmask8 le = _mm512_cmp_pd_mask(_mm512_set1_pd(keys[N - 1]), t,
+                                               _CMP_LE_OQ);
+        return UnrolledCount< N - 1 >::Apply(keys, t,
+                   _mm512_mask_add_epi64(count, le, count,
+                                         _mm512_set1_epi64(1)));
+    }
+};
+template <>
+struct UnrolledCount< 0 > {
+    __attribute__((target("avx2")))
+    static __m256d Apply(const double*, __m256d, __m256d count) {
+        return count;
+    }
+    __attribute__((target("avx512f,avx2")))
+    static __m512i Apply(const double*, __m512d, __m512i count) {
+        return count;
+    }
+};
+#endif
+} //namespace detail
+
+//------------------------------------------------------------------------------
+template < typename MapT, ColormapKernel::Interpolation INTERPOLATION >
+class StaticColormapKernel {
+public:
+    enum {SIZE = MapT::SIZE,
+          SEGMENTS = SIZE - 1,
+          LEVELS = detail::Log2Ceil< SEGMENTS >::value,
+          SEARCH_SIZE = (std::size_t(1) << LEVELS) > 1 ?
+                        (std::size_t(1) << LEVELS) - 1 : 1,
+          LINEAR_SEARCH = int(SEGMENTS)
+                          <= int(ColormapKernel::LINEAR_SEARCH_SIZE)};
+    static_assert(SIZE >= 2, "Colormaps need at least two colors");
+    explicit StaticColormapKernel(double scalingFactor = 255.0)
+        : scale_(scalingFactor) {
+        const double* rgb = MapT::Colors();
+        const double* k = MapT::Keys();
+        Vector3D< double > p[SIZE];
+        for(std::size_t i = 0; i != SIZE; ++i)
+            p[i] = Vector3D< double >(rgb[3 * i], rgb[3 * i + 1],
+                                      rgb[3 * i + 2]);
+        for(std::size_t i = 0; i != SEARCH_SIZE; ++i)
+            search_[i] = i + 1 < SIZE - 1 ? k[i + 1]
+                         : std::numeric_limits< double >::infinity();
+        first_ = k[0];
+        last_ = k[SIZE - 1];
+        for(std::size_t s = 0; s != SEGMENTS; ++s) {
+            const double w = k[s + 1] - k[s];
+            key_[s] = k[s];
+            invWidth_[s] = w > 0.0 ? 1.0 / w : 0.0;
+            Vector3D< double > c[4];
+            ColormapKernel::SegmentCoefficients(p, SIZE, s, INTERPOLATION, c);
+            //HSV colors are scaled after the conversion to RGB
+            const double f = MapT::HSV ? 1.0 : scalingFactor;
+            for(int ch = 0; ch != 3; ++ch)
+                for(int i = 0; i != 4; ++i)
+                    coeff_[ch][i][s] = f * c[i][ch];
+        }
+    }
+    ///Colorize [begin, end) into out, which must hold 3 * (end - begin)
+    ///elements; [minVal, maxVal] is mapped to [0, 1]
+    void Map(const double* begin, const double* end, ColorType* out,
+             double minVal, double maxVal) const {
+        assert(maxVal >= minVal);
+        const double invRange = maxVal > minVal ? 1.0 / (maxVal - minVal)
+                                                : 0.0;
+        const std::size_t n = std::size_t(end - begin);
+        std::size_t done = 0;
+#ifdef SCOLOR_X86_SIMD
+        const ColormapKernel::ISA isa = ColormapKernel::DetectISA();
+        if(isa == ColormapKernel::AVX512)
+            done = MapAVX512(begin, n, out, minVal, invRange);
+        else if(isa == ColormapKernel::AVX2)
+            done = MapAVX2(begin, n, out, minVal, invRange);
+#endif
+        for(std::size_t i = done; i != n; ++i) {
+            double t = (begin[i] - minVal) * invRange;
+            if(!(t > first_)) t = first_;
+            if(t > last_) t = last_;
+            const std::size_t s = Segment(t);
+            const double u = (t - key_[s]) * invWidth_[s];
+            double v[3];
+            for(int ch = 0; ch != 3; ++ch) {
+                v[ch] = INTERPOLATION == ColormapKernel::LINEAR ?
+                        coeff_[ch][1][s] * u + coeff_[ch][0][s]
+                        : ((coeff_[ch][3][s] * u + coeff_[ch][2][s]) * u
+                           + coeff_[ch][1][s]) * u + coeff_[ch][0][s];
+            }
+            if(MapT::HSV) ColormapKernel::HSVToRGB(v, scale_);
+            for(int ch = 0; ch != 3; ++ch)
+                out[3 * i + ch] = ColormapKernel::Saturate(v[ch]);
+        }
+    }
+private:
+    ///Segment containing t in [first_, last_]
+    std::size_t Segment(double t) const {
+        return detail::UnrolledSearch< (std::size_t(1) << LEVELS) / 2 >::
+               Apply(search_, t, 0);
+    }
+#ifdef SCOLOR_X86_SIMD
+    __attribute__((target("avx2")))
+    std::size_t MapAVX2(const double* in, std::size_t n, ColorType* out,
+                        double minVal, double invRange) const {
+        const std::size_t nv = n - n % 4;
+        const __m256d vmin = _mm256_set1_pd(minVal);
+        const __m256d vinv = _mm256_set1_pd(invRange);
+        const __m256d vfirst = _mm256_set1_pd(first_);
+        const __m256d vlast = _mm256_set1_pd(last_);
+        const __m256d zero = _mm256_setzero_pd();
+        const __m256d v255 = _mm256_set1_pd(255.0);
+        for(std::size_t i = 0; i != nv; i += 4, out += 12) {
+            __m256d t = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(in + i),
+                                                    vmin), vinv);
+            //NaN -> first key
+            t = _mm256_min_pd(_mm256_max_pd(t, vfirst), vlast);
+            alignas(16) int si[4];
+            if(LINEAR_SEARCH) {
+                //segment = number of interior keys <= t
+                const __m256d count = detail::UnrolledCount<
+                    LINEAR_SEARCH ? SEGMENTS - 1 : 0 >::Apply(search_, t, zero);
+                _mm_store_si128(reinterpret_cast< __m128i* >(si),
+                                _mm256_cvttpd_epi32(count));
+            } else {
+                alignas(32) double ts[4];
+                _mm256_store_pd(ts, t);
+                for(int l = 0; l != 4; ++l) si[l] = int(Segment(ts[l]));
+            }
+            const __m256d u = _mm256_mul_pd(
+                _mm256_sub_pd(t, ColormapKernel::Gather4(key_, si)),
+                ColormapKernel::Gather4(invWidth_, si));
+            __m256d v[3];
+            for(int ch = 0; ch != 3; ++ch) {
+                if(INTERPOLATION == ColormapKernel::LINEAR) {
+                    v[ch] = _mm256_add_pd(
+                        _mm256_mul_pd(ColormapKernel::Gather4(coeff_[ch][1],
+                                                              si), u),
+                        ColormapKernel::Gather4(coeff_[ch][0], si));
+                    continue;
+                }
+                v[ch] = ColormapKernel::Gather4(coeff_[ch][3], si);
+                for(int k = 2; k >= 0; --k) {
+                    v[ch] = _mm256_add_pd(_mm256_mul_pd(v[ch], u),
+                                ColormapKernel::Gather4(coeff_[ch][k], si));
+                }
+            }
+            if(MapT::HSV) ColormapKernel::HSVToRGB(v, scale_);
+            __m128i rgb[3];
+            for(int ch = 0; ch != 3; ++ch) {
+                const __m256d c = _mm256_min_pd(_mm256_max_pd(v[ch], zero),
+                                                v255);
+                rgb[ch] = _mm256_cvttpd_epi32(c);
+            }
+            ColormapKernel::Store4RGB(rgb[0], rgb[1], rgb[2], out);
+        }
+        return nv;
+    }
+    __attribute__((target("avx512f,avx2")))
+    std::size_t MapAVX512(const double* in, std::size_t n, ColorType* out,
+                          double minVal, double invRange) const {
+        const std::size_t nv = n - n % 8;
+        const __m512d vmin = _mm512_set1_pd(minVal);
+        const __m512d vinv = _mm512_set1_pd(invRange);
+        const __m512d vfirst = _mm512_set1_pd(first_);
+        const __m512d vlast = _mm512_set1_pd(last_);
+        const __m512d zero = _mm512_setzero_pd();
+        const __m512d v255 = _mm512_set1_pd(255.0);
+        for(std::size_t i = 0; i != nv; i += 8, out += 24) {
+            __m512d t = _mm512_mul_pd(_mm512_sub_pd(_mm512_loadu_pd(in + i),
+                                                    vmin), vinv);
+            //NaN -> first key
+            t = _mm512_min_pd(_mm512_max_pd(t, vfirst), vlast);
+            const __m256i s = LINEAR_SEARCH ?
+                _mm512_cvtepi64_epi32(detail::UnrolledCount<
+                    LINEAR_SEARCH ? SEGMENTS - 1 : 0 >::Apply(
+                        search_, t, _mm512_setzero_si512()))
+                : detail::UnrolledSearch< (std::size_t(1) << LEVELS) / 2 >::
+                      Apply(search_, t, _mm256_setzero_si256());
+            const __m512d u = _mm512_mul_pd(
+                _mm512_sub_pd(t, _mm512_i32gather_pd(s, key_, 8)),
+                _mm512_i32gather_pd(s, invWidth_, 8));
+            __m512d v[3];
+            for(int ch = 0; ch != 3; ++ch) {
+                if(INTERPOLATION == ColormapKernel::LINEAR) {
+                    v[ch] = _mm512_add_pd(
+                        _mm512_mul_pd(_mm512_i32gather_pd(s, coeff_[ch][1], 8),
+                                      u),
+                        _mm512_i32gather_pd(s, coeff_[ch][0], 8));
+                    continue;
+                }
+                v[ch] = _mm512_i32gather_pd(s, coeff_[ch][3], 8);
+                for(int k = 2; k >= 0; --k) {
+                    v[ch] = _mm512_add_pd(_mm512_mul_pd(v[ch], u),
+                                _mm512_i32gather_pd(s, coeff_[ch][k], 8));
+                }
+            }
+            if(MapT::HSV) ColormapKernel::HSVToRGB(v, scale_);
+            __m256i rgb[3];
+            for(int ch = 0; ch != 3; ++ch) {
+                const __m512d c = _mm512_min_pd(_mm512_max_pd(v[ch], zero),
+                                                v255);
+                rgb[ch] = _mm512_cvttpd_epi32(c);
+            }
+            ColormapKernel::Store4RGB(_mm256_castsi256_si128(rgb[0]),
+                                      _mm256_castsi256_si128(rgb[1]),
+                                      _mm256_castsi256_si128(rgb[2]), out);
+            ColormapKernel::Store4RGB(_mm256_extracti128_si256(rgb[0], 1),
+                                      _mm256_extracti128_si256(rgb[1], 1),
+                                      _mm256_extracti128_si256(rgb[2], 1),
+                                      out + 12);
+        }
+        return nv;
+    }
+#endif
+private:
+    double scale_;
+    double first_;
+    double last_;
+    double search_[SEARCH_SIZE];
+    double key_[SEGMENTS];
+    double invWidth_[SEGMENTS];
+    ///c[0] + c[1] u + c[2] u^2 + c[3] u^3: coeff_[channel][i][segment]
+    double coeff_[3][4][SEGMENTS];
+};
+
+///Map [begin, end) through the kernel of @c MapT, built on first use with
+///colors scaled to [0, 255]
+template < typename MapT, ColormapKernel::Interpolation INTERPOLATION >
+void MapStatic(const double* begin, const double* end, ColorType* out,
+               double minVal, double maxVal) {
+    static const StaticColormapKernel< MapT, INTERPOLATION > kernel(255.0);
+    kernel.Map(begin, end, out, minVal, maxVal);
+}
+
+//------------------------------------------------------------------------------
+///Entry of the registry of built-in colormaps, see BuiltinColormaps
+struct BuiltinColormap {
+    using MapFunction = void (*)(const double*, const double*, ColorType*,
+                                 double, double);
+    const char* name;
+    std::size_t size;
+    ///size r, g, b triplets in [0, 1], HSV if hsv
+    const double* colors;
+    const double* keys;
+    bool hsv;
+    MapFunction linear;
+    MapFunction cubic;
+    std::vector< Vector3D< double > > Colors() const {
+        std::vector< Vector3D< double > > c;
+        for(std::size_t i = 0; i != size; ++i)
+            c.push_back(Vector3D< double >(colors[3 * i], colors[3 * i + 1],
+                                           colors[3 * i + 2]));
+        return c;
+    }
+    std::vector< double > Keys() const {
+        return std::vector< double >(keys, keys + size);
+    }
+    MapFunction Kernel(bool catmullRom) const {
+        return catmullRom ? cubic : linear;
+    }
+};
+
+///Registry entry of a built-in colormap type
+template < typename MapT >
+BuiltinColormap MakeBuiltinColormap() {
+    return BuiltinColormap{MapT::Id(), std::size_t(MapT::SIZE),
+                           MapT::Colors(), MapT::Keys(), MapT::HSV != 0,
+                           &MapStatic< MapT, ColormapKernel::LINEAR >,
+                           &MapStatic< MapT, ColormapKernel::CATMULL_ROM >};
+}
@@ -0,0 +1,318 @@
+#pragma once
+#include <cstddef>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <utility>
+
+#include "ParallelFor.h"
+
+//------------------------------------------------------------------------------
+///Per-frame statistics, NaNs are always left out, infinities too with
+///StatisticsOptions::finite
+struct FrameStatistics {
+    double min = std::numeric_limits< double >::quiet_NaN();
+    double max = std::numeric_limits< double >::quiet_NaN();
+    std::size_t count = 0;
+    double mean = std::numeric_limits< double >::quiet_NaN();
+    double stddev = std::numeric_limits< double >::quiet_NaN();
+    ///number of distinct values and most frequent value, valid if
+    ///levels > 0
+    std::size_t levels = 0;
+    double mode = std::numeric_limits< double >::quiet_NaN();
+    std::size_t modeCount = 0;
+    ///fixed width bins over [min, max]
+    std::vector< std::size_t > histogram;
+    ///adaptive (equal count) bins: bins + 1 edges
+    std::vector< double > adaptiveEdges;
+    ///(percentile in [0, 100], value)
+    std::vector< std::pair< double, double > > percentiles;
+};
+
+struct StatisticsOptions {
+    ///number of fixed width histogram bins, 0 = no histogram
+    std::size_t bins = 0;
+    ///number of equal count histogram bins, 0 = no adaptive histogram
+    std::size_t adaptiveBins = 0;
+    ///percentiles to compute, in [0, 100]
+    std::vector< double > percentiles;
+    ///count distinct values and find the most frequent one
+    bool levels = true;
+    ///leave infinities out, as -finite does for the data range
+    bool finite = false;
+    int threads = 1;
+    bool SortRequired() const {
+        return levels || adaptiveBins || !percentiles.empty();
+    }
+};
+
+//------------------------------------------------------------------------------
+///Single pass statistics: count, mean, standard deviation and fixed width
+///histogram over [min, max], values out of the range are counted in the end
+///bins. Add can be called concurrently on different blocks of the same
+///frame, e.g. by the colorization workers, so that the statistics are
+///computed in the same pass as colorization. NaNs are skipped, infinities
+///too if @c finite.
+class StatisticsAccumulator {
+public:
+    StatisticsAccumulator(double minVal, double maxVal, std::size_t bins = 0,
+                          bool finite = false)
+        : min_(minVal), max_(maxVal), finite_(finite), histogram_(bins, 0) {}
+    template < typename T >
+    void Add(const T* begin, const T* end) {
+        std::vector< std::size_t > h(histogram_.size(), 0);
+        const double range = max_ - min_;
+        const double scale = range > 0.0 ? double(h.size()) / range : 0.0;
+        //sums shifted by the first value for numerical stability
+        std::size_t n = 0;
+        double shift = 0.0;
+        double s1 = 0.0;
+        double s2 = 0.0;
+        for(; begin != end; ++begin) {
+            const double v = double(*begin);
+            if(v != v || (finite_ && v - v != 0.0)) continue;
+            if(!n) shift = v;
+            ++n;
+            const double d = v - shift;
+            s1 += d;
+            s2 += d * d;
+            if(!h.empty()) {
+                //clamped before the conversion: infinities and values far
+                //out of the range do not fit in a size_t
+                const double x = (v - min_) * scale;
+                ++h[x > 0.0 ? std::size_t(std::min(x, double(h.size() - 1)))
+                            : 0];
+            }
+        }
+        Moments m;
+        m.n = n;
+        if(n) {
+            m.mean = shift + s1 / double(n);
+            m.m2 = std::max(0.0, s2 - s1 * s1 / double(n));
+        }
+        std::lock_guard< std::mutex > lock(mutex_);
+        moments_.Merge(m);
+        for(std::size_t i = 0; i != h.size(); ++i) histogram_[i] += h[i];
+    }
+    void Get(FrameStatistics& s) const {
+        s.min = min_;
+        s.max = max_;
+        s.count = moments_.n;
+        if(moments_.n) {
+            s.mean = moments_.mean;
+            s.stddev = std::sqrt(moments_.m2 / double(moments_.n));
+        }
+        s.histogram = histogram_;
+    }
+private:
+    struct Moments {
+        std::size_t n = 0;
+        double mean = 0.0;
+        double m2 = 0.0;
+        ///Chan et al. pairwise merge
+        void Merge(const Moments& o) {
+            if(!o.n) return;
+            const double nt = double(n + o.n);
+            const double d = o.mean - mean;
+            mean += d * double(o.n) / nt;
+            m2 += o.m2 + d * d * double(n) * double(o.n) / nt;
+            n += o.n;
+        }
+    };
+private:
+    double min_;
+    double max_;
+    bool finite_;
+    Moments moments_;
+    std::vector< std::size_t > histogram_;
+    std::mutex mutex_;
+};
+
+//------------------------------------------------------------------------------
+///Sort with chunks sorted in parallel and merged pairwise, in parallel
+inline void ParallelSort(std::vector< double >& v, int threads) {
+    const std::size_t n = v.size();
+    if(threads < 2 || n < (1 << 16)) {
+        std::sort(v.begin(), v.end());
+        return;
+    }
+    const std::size_t chunk = (n + threads - 1) / threads;
+    ParallelFor(n, chunk, threads, [&v](std::size_t b, std::size_t e) {
+        std::sort(v.begin() + b, v.begin() + e);
+    });
+    for(std::size_t width = chunk; width < n; width *= 2) {
+        const std::size_t pairs = (n + 2 * width - 1) / (2 * width);
+        ParallelFor(pairs, 1, threads, [&](std::size_t b, std::size_t e) {
+            for(std::size_t p = b; p != e; ++p) {
+                const std::size_t first = p * 2 * width;
+                const std::size_t middle = std::min(n, first + width);
+                const std::size_t last = std::min(n, first + 2 * width);
+                std::inplace_merge(v.begin() + first, v.begin() + middle,
+                                   v.begin() + last);
+            }
+        });
+    }
+}
+
+///Linearly interpolated percentile of sorted data, p in [0, 100]
+inline double Percentile(const std::vector< double >& sorted, double p) {
+    if(sorted.empty()) return std::numeric_limits< double >::quiet_NaN();
+    const double x = std::min(std::max(p, 0.0), 100.0) / 100.0
+                     * double(sorted.size() - 1);
+    const std::size_t i = std::size_t(x);
+    if(i + 1 >= sorted.size()) return sorted.back();
+    return sorted[i] + (x - double(i)) * (sorted[i + 1] - sorted[i]);
+}
+
+//------------------------------------------------------------------------------
+///Order based statistics: distinct levels and most frequent value,
+///percentiles and adaptive histogram edges. The data is copied and sorted
+///once, O(N log N) with a single allocation.
+template < typename T >
+void SortedStatistics(const T* begin, const T* end,
+                      const StatisticsOptions& options,
+                      FrameStatistics& s) {
+    std::vector< double > sorted;
+    sorted.reserve(std::size_t(end - begin));
+    for(; begin != end; ++begin) {
+        const double v = double(*begin);
+        if(v == v && (!options.finite || v - v == 0.0)) sorted.push_back(v);
+    }
+    ParallelSort(sorted, options.threads);
+    if(options.levels && !sorted.empty()) {
+        s.levels = 0;
+        s.modeCount = 0;
+        for(std::size_t i = 0; i != sorted.size();) {
+            std::size_t j = i + 1;
+            while(j != sorted.size() && sorted[j] == sorted[i]) ++j;
+            ++s.levels;
+            if(j - i > s.modeCount) {
+                s.modeCount = j - i;
+                s.mode = sorted[i];
+            }
+            i = j;
+        }
+    }
+    s.percentiles.clear();
+    for(double p: options.percentiles) {
+        s.percentiles.push_back(std::make_pair(p, Percentile(sorted, p)));
+    }
+    s.adaptiveEdges.clear();
+    for(std::size_t b = 0; options.adaptiveBins && b <= options.adaptiveBins;
+        ++b) {
+        s.adaptiveEdges.push_back(
+            Percentile(sorted, 100.0 * double(b) / options.adaptiveBins));
+    }
+}
+
+///All the statistics selected by @c options in at most two passes,
+///[minVal, maxVal] is the histogram range
+template < typename T >
+FrameStatistics Statistics(const T* begin, const T* end,
+                           double minVal, double maxVal,
+                           const StatisticsOptions& options) {
+    StatisticsAccumulator acc(minVal, maxVal, options.bins, options.finite);
+    ParallelFor(std::size_t(end - begin), 1 << 20, options.threads,
+                [&](std::size_t b, std::size_t e) {
+                    acc.Add(begin + b, begin + e);
+                });
+    FrameStatistics s;
+    acc.Get(s);
+    if(options.SortRequired()) SortedStatistics(begin, end, options, s);
+    return s;
+}
+
+//------------------------------------------------------------------------------
+///One line summary followed by percentiles and histograms, if any
+inline std::string ToText(const std::string& name, const FrameStatistics& s) {
+    std::ostringstream os;
+    os << name
+       << ": min = " << s.min
+       << "  max = " << s.max;
+    if(s.levels) {
+        os << "  # levels = " << s.levels
+           << "  max levels = " << s.mode << "->" << s.modeCount;
+    }
+    os << "  mean = " << s.mean
+       << "  stddev = " << s.stddev
+       << '\n';
+    if(!s.percentiles.empty()) {
+        os << "  percentiles:";
+        for(auto& p: s.percentiles) os << "  " << p.first << "% = " << p.second;
+        os << '\n';
+    }
+    if(!s.histogram.empty()) {
+        os << "  histogram:";
+        for(auto c: s.histogram) os << ' ' << c;
+        os << '\n';
+    }
+    if(!s.adaptiveEdges.empty()) {
+        os << "  adaptive histogram edges:";
+        for(auto e: s.adaptiveEdges) os << ' ' << e;
+        os << '\n';
+    }
+    return os.str();
+}
+
+namespace detail {
+inline std::string JSONNumber(double v) {
+    if(!std::isfinite(v)) return "null";
+    std::ostringstream os;
+    os << std::setprecision(17) << v;
+    return os.str();
+}
+
+inline std::string JSONString(const std::string& s) {
+    std::string r = "\"";
+    for(char c: s) {
+        if(c == '"' || c == '\\') r += '\\';
+        r += c;
+    }
+    return r + '"';
+}
+} //namespace detail
+
+///Single line JSON object
+inline std::string ToJSON(const std::string& name, const FrameStatistics& s) {
+    using detail::JSONNumber;
+    std::ostringstream os;
+    os << "{\"file\": " << detail::JSONString(name)
+       << ", \"min\": " << JSONNumber(s.min)
+       << ", \"max\": " << JSONNumber(s.max)
+       << ", \"count\": " << s.count
+       << ", \"mean\": " << JSONNumber(s.mean)
+       << ", \"stddev\": " << JSONNumber(s.stddev);
+    if(s.levels) {
+        os << ", \"levels\": " << s.levels
+           << ", \"mode\": " << JSONNumber(s.mode)
+           << ", \"mode_count\": " << s.modeCount;
+    }
+    if(!s.percentiles.empty()) {
+        os << ", \"percentiles\": {";
+        for(std::size_t i = 0; i != s.percentiles.size(); ++i) {
+            if(i) os << ", ";
+            os << '"' << s.percentiles[i].first << "\": "
+               << JSONNumber(s.percentiles[i].second);
+        }
+        os << '}';
+    }
+    if(!s.histogram.empty()) {
+        os << ", \"histogram\": [";
+        for(std::size_t i = 0; i != s.histogram.size(); ++i)
+            os << (i ? ", " : "") << s.histogram[i];
+        os << ']';
+    }
+    if(!s.adaptiveEdges.empty()) {
+        os << ", \"adaptive_edges\": [";
+        for(std::size_t i = 0; i != s.adaptiveEdges.size(); ++i)
+            os << (i ? ", " : "") << JSONNumber(s.adaptiveEdges[i]);
+        os << ']';
+    }
+    os << "}\n";
+    return os.str();
+}
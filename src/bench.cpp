@@ -0,0 +1,354 @@
+//g++ -std=c++11 -O2 -pthread bench.cpp -lturbojpeg -ljpeg -lpng -lz -o bench
+//Microbenchmarks of the per-pixel hot paths: interpolation, color conversion,
+//frame reading and JPEG encoding, over a range of frame and colormap sizes.
+//Results are printed as one JSON object to stdout; each entry holds the
+//median and minimum of the timed runs, after one untimed warm-up run, in
+//ns/pixel and MB/s of input data (scalars, or RGB pixels for the encoder).
+//Input data is generated from a fixed seed: runs on the same machine are
+//directly comparable.
+#include <cstdio>
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+#include "Colormap.h"
+#include "BuiltinMaps.h"
+#include "FrameSource.h"
+#include "Statistics.h"
+#include "imageio.h"
+
+using namespace std;
+
+//------------------------------------------------------------------------------
+struct BenchOptions {
+    vector< int > sizes = {256, 1024};
+    string maps = "../maps";
+    string tmp = ".";
+    int runs = 5;
+    ///benchmarks whose name contains filter, all if empty
+    string filter;
+};
+
+struct Result {
+    string name;
+    string map;
+    int keys;
+    int width;
+    int height;
+    double medianSeconds;
+    double minSeconds;
+    ///bytes of input per pixel
+    double bytesPerPixel;
+};
+
+///Median and minimum time of @c runs calls of @c f after a warm-up call
+pair< double, double > Time(int runs, const function< void () >& f) {
+    f();
+    vector< double > t;
+    for(int r = 0; r != runs; ++r) {
+        const auto start = chrono::steady_clock::now();
+        f();
+        t.push_back(chrono::duration< double >(chrono::steady_clock::now()
+                                               - start).count());
+    }
+    sort(t.begin(), t.end());
+    return make_pair(t[t.size() / 2], t.front());
+}
+
+///Frame of @c n values in [0, 1]: gradient plus noise from a fixed seed
+vector< double > TestFrame(size_t n) {
+    vector< double > d(n);
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for(size_t i = 0; i != n; ++i) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        const double noise = double(state >> 11) / double(1ull << 53);
+        d[i] = 0.8 * double(i) / double(n) + 0.2 * noise;
+    }
+    return d;
+}
+
+///Write @c n bytes as a BGZF file, as bgzip does: gzip members of at most
+///64 KiB, each with its compressed size in a "BC" extra field
+void WriteBGZF(const string& fname, const char* data, size_t n) {
+    ofstream os(fname, ios::binary);
+    const size_t block = 0xff00;
+    vector< unsigned char > out(0x10000);
+    for(size_t i = 0; i < n; i += block) {
+        const size_t size = min(block, n - i);
+        unsigned char extra[] = {'B', 'C', 2, 0, 0, 0};
+        gz_header h = {};
+        h.extra = extra;
+        h.extra_len = sizeof(extra);
+        h.os = 255;
+        z_stream z = {};
+        if(deflateInit2(&z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS,
+                        8, Z_DEFAULT_STRATEGY) != Z_OK
+           || deflateSetHeader(&z, &h) != Z_OK)
+            throw runtime_error("Cannot compress data");
+        z.next_in = reinterpret_cast< unsigned char* >(
+            const_cast< char* >(data + i));
+        z.avail_in = uInt(size);
+        z.next_out = out.data();
+        z.avail_out = uInt(out.size());
+        const int r = deflate(&z, Z_FINISH);
+        const size_t bsize = out.size() - z.avail_out;
+        deflateEnd(&z);
+        if(r != Z_STREAM_END) throw runtime_error("Cannot compress data");
+        out[16] = (bsize - 1) & 0xff;
+        out[17] = (bsize - 1) >> 8;
+        os.write(reinterpret_cast< const char* >(out.data()), bsize);
+    }
+    if(!os) throw runtime_error("Cannot write to file");
+}
+
+ColorType ToColor(double v) {
+    return v > 255.0 ? ColorType(255) : v > 0.0 ? ColorType(v) : ColorType(0);
+}
+
+string ToJSON(const Result& r) {
+    using detail::JSONNumber;
+    using detail::JSONString;
+    const double pixels = double(r.width) * r.height;
+    ostringstream os;
+    os << "{\"name\": " << JSONString(r.name)
+       << ", \"map\": " << JSONString(r.map)
+       << ", \"keys\": " << r.keys
+       << ", \"width\": " << r.width << ", \"height\": " << r.height
+       << ", \"median_ms\": " << JSONNumber(1e3 * r.medianSeconds)
+       << ", \"min_ms\": " << JSONNumber(1e3 * r.minSeconds)
+       << ", \"ns_per_pixel\": " << JSONNumber(1e9 * r.medianSeconds / pixels)
+       << ", \"mb_per_s\": "
+       << JSONNumber(r.bytesPerPixel * pixels / r.medianSeconds / 1e6) << '}';
+    return os.str();
+}
+
+//------------------------------------------------------------------------------
+///Colormap file of maps/ and the name of the same built-in colormap
+struct MapFile {
+    const char* file;
+    const char* builtin;
+};
+
+const MapFile MAPS[] = {{"CoolWarmFloat5.csv", "CoolWarmFloat5"},
+                        {"CoolWarmFloat33.csv", "CoolWarmFloat33"},
+                        {"CoolWarmFloat257.csv", "CoolWarmFloat257"}};
+
+class Bench {
+public:
+    explicit Bench(const BenchOptions& o) : o_(o) {}
+    void Run() {
+        for(int s: o_.sizes) {
+            const size_t n = size_t(s) * s;
+            const vector< double > data = TestFrame(n);
+            vector< ColorType > rgb(3 * n);
+            for(const MapFile& m: MAPS) Colormaps(m, s, data, rgb);
+            Conversions(s, data, rgb);
+            IO(s, data, rgb);
+        }
+    }
+    const vector< Result >& Results() const { return results_; }
+private:
+    bool Selected(const string& name) const {
+        return o_.filter.empty() || name.find(o_.filter) != string::npos;
+    }
+    void Add(const string& name, const string& map, int keys, int size,
+             double bytesPerPixel, const function< void () >& f) {
+        if(!Selected(name)) return;
+        const pair< double, double > t = Time(o_.runs, f);
+        results_.push_back(Result{name, map, keys, size, size, t.first,
+                                  t.second, bytesPerPixel});
+        cerr << ToJSON(results_.back()) << endl;
+    }
+    void Colormaps(const MapFile& m, int size, const vector< double >& data,
+                   vector< ColorType >& rgb) {
+        const KeyData kd = ReadColormap(o_.maps + '/' + m.file, true, 1.0,
+                                        false, false);
+        const vector< Vector3D< double > >& colors = get< KEYFRAME::DATA >(kd);
+        const vector< double >& keys = get< KEYFRAME::KEYS >(kd);
+        const vector< double > dist = ComputeDistances(colors.begin(),
+                                                       colors.end());
+        const int nkeys = int(colors.size());
+        const double* b = data.data();
+        const double* e = b + data.size();
+        ColorType* out = rgb.data();
+        Add("LinearInterpolation", m.builtin, nkeys, size, sizeof(double),
+            [&]() {
+            ColorType* o = out;
+            for(const double* i = b; i != e; ++i, o += 3) {
+                const Vector3D< double > c =
+                    255.0 * LinearInterpolation(colors, keys, *i, 0.0, 1.0);
+                o[0] = ToColor(c[0]);
+                o[1] = ToColor(c[1]);
+                o[2] = ToColor(c[2]);
+            }
+        });
+        Add("KeyFramedCRomInterpolation", m.builtin, nkeys, size,
+            sizeof(double), [&]() {
+            ColorType* o = out;
+            for(const double* i = b; i != e; ++i, o += 3) {
+                const Vector3D< double > c =
+                    255.0 * KeyFramedCRomInterpolation(colors, keys, *i);
+                o[0] = ToColor(c[0]);
+                o[1] = ToColor(c[1]);
+                o[2] = ToColor(c[2]);
+            }
+        });
+        const CompiledSpline< double > spline(colors, keys);
+        Add("CompiledSpline", m.builtin, nkeys, size, sizeof(double), [&]() {
+            ColorType* o = out;
+            for(const double* i = b; i != e; ++i, o += 3) {
+                const Vector3D< double > c = 255.0 * spline(*i);
+                o[0] = ToColor(c[0]);
+                o[1] = ToColor(c[1]);
+                o[2] = ToColor(c[2]);
+            }
+        });
+        //CRomInterpolation is only valid at the parameters of the control
+        //points before the last one: FindPos returns the end of the segment
+        //holding t, timed on those parameters
+        vector< double > points(data.size());
+        for(size_t i = 0; i != points.size(); ++i)
+            points[i] = dist[size_t(data[i] * (nkeys - 1)) % (nkeys - 1)];
+        Add("CRomInterpolation", m.builtin, nkeys, size, sizeof(double),
+            [&]() {
+            ColorType* o = out;
+            for(const double* i = points.data();
+                i != points.data() + points.size(); ++i, o += 3) {
+                const Vector3D< double > c =
+                    255.0 * CRomInterpolation(colors, dist, *i);
+                o[0] = ToColor(c[0]);
+                o[1] = ToColor(c[1]);
+                o[2] = ToColor(c[2]);
+            }
+        });
+        for(int cubic = 0; cubic != 2; ++cubic) {
+            const string suffix = cubic ? "Cubic" : "Linear";
+            const ColormapLUT lut = MakeLUT(colors, keys, cubic != 0, false,
+                                            255.0, ColormapLUT::DEFAULT_SIZE,
+                                            false);
+            Add("ColormapLUT" + suffix, m.builtin, nkeys, size,
+                sizeof(double), [&]() { lut.Map(b, e, out, 0.0, 1.0); });
+            const ColormapKernel kernel(colors, keys,
+                                        cubic ? ColormapKernel::CATMULL_ROM
+                                              : ColormapKernel::LINEAR,
+                                        255.0);
+            Add("ColormapKernel" + suffix, m.builtin, nkeys, size,
+                sizeof(double), [&]() { kernel.Map(b, e, out, 0.0, 1.0); });
+            const BuiltinColormap* builtin = FindBuiltinColormap(m.builtin);
+            if(!builtin) continue;
+            const BuiltinColormap::MapFunction f = builtin->Kernel(cubic != 0);
+            Add("StaticColormapKernel" + suffix, m.builtin, nkeys, size,
+                sizeof(double), [&]() { f(b, e, out, 0.0, 1.0); });
+        }
+    }
+    void Conversions(int size, const vector< double >& data,
+                     vector< ColorType >& pixels) {
+        const double* b = data.data();
+        const double* e = b + data.size();
+        ColorType* out = pixels.data();
+        //hue, saturation and value derived from the same frame
+        Add("hsv2rgb", "", 0, size, 3 * sizeof(double), [&]() {
+            ColorType* o = out;
+            for(const double* i = b; i != e; ++i, o += 3) {
+                const rgb c = hsv2rgb(hsv(360.0 * *i, 0.5 + 0.5 * *i,
+                                          1.0 - 0.5 * *i));
+                o[0] = ToColor(255.0 * c.r);
+                o[1] = ToColor(255.0 * c.g);
+                o[2] = ToColor(255.0 * c.b);
+            }
+        });
+        Add("ScalarToGray", "", 0, size, sizeof(double), [&]() {
+            ScalarToGray(b, e, out, 0.0, 1.0, 255.0);
+        });
+    }
+    void IO(int size, const vector< double >& data,
+            const vector< ColorType >& rgb) {
+        const string in = o_.tmp + "/bench-" + to_string(size) + ".f64";
+        {
+            ofstream os(in, ios::binary);
+            os.write(reinterpret_cast< const char* >(data.data()),
+                     data.size() * sizeof(double));
+            if(!os) throw runtime_error("Cannot write to file");
+        }
+        //same as cmap reading a frame: memory map and range of the frame
+        Add("ReadFile", "", 0, size, sizeof(double), [&]() {
+            const ScalarFrame< double > f(in);
+            const ScalarRange< double > r = MinMax(f.begin(), f.end());
+            if(!r.count) throw runtime_error("No valid values in file");
+        });
+        remove(in.c_str());
+        //decompression of a gzip frame in parallel blocks, on all the cores
+        const string gz = in + ".gz";
+        WriteBGZF(gz, reinterpret_cast< const char* >(data.data()),
+                  data.size() * sizeof(double));
+        const int threads = max(1, int(thread::hardware_concurrency()));
+        Add("ReadFileBGZF", "", 0, size, sizeof(double), [&]() {
+            const ScalarFrame< double > f(gz, false, threads);
+            const ScalarRange< double > r = MinMax(f.begin(), f.end());
+            if(!r.count) throw runtime_error("No valid values in file");
+        });
+        remove(gz.c_str());
+        const string jpg = o_.tmp + "/bench-" + to_string(size) + ".jpg";
+        JPEGWriter writer;
+        Add("JPEGWriter::Save", "", 0, size, 3, [&]() {
+            writer.Save(size, size, jpg.c_str(), rgb.data());
+        });
+        remove(jpg.c_str());
+    }
+private:
+    BenchOptions o_;
+    vector< Result > results_;
+};
+
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+    const vector< string > args(argv, argv + argc);
+    BenchOptions o;
+    for(size_t i = 1; i < args.size(); ++i) {
+        const bool value = i + 1 < args.size();
+        if(args[i] == "-sizes" && value) {
+            o.sizes.clear();
+            istringstream is(args[++i]);
+            string s;
+            while(getline(is, s, ',')) o.sizes.push_back(stoi(s));
+        } else if(args[i] == "-maps" && value) o.maps = args[++i];
+        else if(args[i] == "-tmp" && value) o.tmp = args[++i];
+        else if(args[i] == "-runs" && value) o.runs = max(1, stoi(args[++i]));
+        else if(args[i] == "-filter" && value) o.filter = args[++i];
+        else {
+            cout << "usage: " << args[0] << " [-sizes <s1,s2...>] "
+                    "[-maps <dir>] [-tmp <dir>] [-runs <n>] [-filter <name>]\n"
+                 << "-sizes:  square frame sizes, default is 256,1024\n"
+                 << "-maps:   colormap directory, default is ../maps\n"
+                 << "-tmp:    directory of the files read and written by the\n"
+                 << "         ReadFile, ReadFileBGZF and JPEGWriter::Save benchmarks\n"
+                 << "-runs:   timed runs per benchmark, default is 5\n"
+                 << "-filter: run only the benchmarks whose name contains\n"
+                 << "         <name>\n"
+                 << "Results go to stdout as JSON, progress to stderr\n";
+            return 1;
+        }
+    }
+    try {
+        Bench bench(o);
+        bench.Run();
+        cout << "{\"isa\": " << detail::JSONString(ColormapKernel::ISAName(
+                                    ColormapKernel::DetectISA()))
+             << ", \"runs\": " << o.runs << ", \"results\": [";
+        const vector< Result >& r = bench.Results();
+        for(size_t i = 0; i != r.size(); ++i)
+            cout << (i ? ",\n  " : "\n  ") << ToJSON(r[i]);
+        cout << "\n]}" << endl;
+    } catch(const exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
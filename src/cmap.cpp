@@ -1,5 +1,7 @@
 
-//clang++ -std=c++11 -stdlib=libc++ ../src/cmap.cpp -I /opt/libjpeg-turbo/include -L /opt/libjpeg-turbo/lib -lturbojpeg -o cmap
+//clang++ -std=c++11 -stdlib=libc++ -pthread ../src/cmap.cpp -I /opt/libjpeg-turbo/include -L /opt/libjpeg-turbo/lib -lturbojpeg -ljpeg -lpng -lz -o cmap
+//add -DSCOLOR_COUNT_ALLOCATIONS to print the number of heap allocations of each frame
+//add -DSCOLOR_WITH_WEBP -lwebp for WebP output
 //./cmap ./ 400x100- 0 0 .out 400 100 -f ../maps/CoolWarmFloat33.csv -csv -stat
 
 #include <string>
@@ -10,219 +12,1554 @@
 #include <algorithm>
 #include <sstream>
 #include <tuple>
-#include <map>
+#include <thread>
+#include <type_traits>
+#include <limits>
+#include <functional>
+#include <mutex>
+#include <cstdint>
+#include <chrono>
+#include <cmath>
+#include <cerrno>
+#include <cstring>
 
 #include "io.h"
+#include "FrameSource.h"
+#include "MinMax.h"
+#include "Statistics.h"
 #include "imageio.h"
 #include "LinearInterpolation.h"
 
 #include "CatmullRom.h"
+#include "ColormapLUT.h"
+#include "ColormapKernel.h"
+#include "Colormap.h"
+#include "BuiltinMaps.h"
+#include "FramePipeline.h"
+#include "AllocationCounter.h"
+#include "Pyramid.h"
+#include "Resample.h"
+#include "Cache.h"
+#include "RangeIndex.h"
+#include "FrameReader.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace std;
 
 //------------------------------------------------------------------------------
-using Data = tuple< std::vector< double >, double, double >;
+template < typename T >
+using Data = tuple< ScalarFrame< T >, T, T >;
 enum {DATASET = 0, DATASET_MIN = 1 , DATASET_MAX = 2};
-Data ReadFile(string path,
-              string prefix,
-              int n,
-              const string& suffix) {
+///Input file name of frame @c n stored into @c name, whose memory is reused
+void FrameFileName(const string& path,
+                   const string& prefix,
+                   int n,
+                   const string& suffix,
+                   string& name) {
     if(path.size() < 1) throw logic_error("Invalid  path size");
-    if(path[path.size()-1] != '/') path += '/';
-    prefix = path + prefix;
-    const string fname = prefix + to_string(n) + suffix;
-    ifstream in(fname, std::ifstream::in
-                    | std::ifstream::binary);
-    if(!in) throw std::runtime_error("Cannot read from file");
-    in.seekg(0, ios::end);
-    const size_t fileSize = in.tellg();
-    in.seekg(0, ios::beg);
-    std::vector< double > buf(fileSize / sizeof(double));
-    in.read(reinterpret_cast< char* >(&buf.front()), fileSize);
-    const double m = *min_element(buf.begin(), buf.end());
-    const double M = *max_element(buf.begin(), buf.end());
-    return make_tuple(buf, m, M);
-}
-
-std::vector< Vector3D< double > > ReadColors(std::istream& is, bool autonorm) {
-    string buf;
-    std::vector< Vector3D< double > > colors;
-    while(is) {
-        getline(is, buf);
-        if(buf.empty()) continue;
-        istringstream iss(buf);
-        if(!iss) throw std::logic_error("Invalid color format");
-        Vector3D< double > color;
-        string r;
-        iss >> r;
-        if(!iss) throw std::logic_error("Invalid color format");
-        string g;
-        iss >> g;
-        if(!iss) throw std::logic_error("Invalid color format");
-        string b;
-        iss >> b;
-        if(r.find("0x") == 0) 
-            color[0] = stoi(r, nullptr, 16) / 255.0;
-        else {
-            color[0] = stod(r);
-            if(autonorm && color[0] > 1.0) color[0] /= 255.0;
-        }
-        if(g.find("0x") == 0) 
-            color[1] = stoi(g, nullptr, 16) / 255.0;
-        else{
-            color[1] = stod(g);
-            if(autonorm && color[1] > 1.0) color[1] /= 255.0;
-        }
-        if(b.find("0x") == 0) 
-            color[2] = stoi(b, nullptr, 16) / 255.0;
-        else {
-            color[2] = stod(b);
-            if(autonorm && color[2] > 1.0) color[2] /= 255.0;
-        }
-        colors.push_back(color);
-    }
-    return colors;
+    name.assign(path);
+    if(path[path.size()-1] != '/') name += '/';
+    name += prefix;
+    name += to_string(n);
+    name += suffix;
 }
 
+string FrameFileName(const string& path,
+                     const string& prefix,
+                     int n,
+                     const string& suffix) {
+    string name;
+    FrameFileName(path, prefix, n, suffix, name);
+    return name;
+}
+
+///Value of type T closest to @c v
+template < typename T >
+T ClampTo(double v) {
+    if(v <= double(numeric_limits< T >::lowest()))
+        return numeric_limits< T >::lowest();
+    if(v >= double(numeric_limits< T >::max()))
+        return numeric_limits< T >::max();
+    return T(v);
+}
 
-using KeyData = std::tuple< std::vector< Vector3D< double > >, std::vector< double > >;
-KeyData ReadColorsCSV(istream& is, double norm) {
-    return Read3DVectorKeyFramesCSV< double >(is, norm);
+///Compute the range of frame @c buf, unless a fixed range is given
+template < typename T >
+Data< T > FrameData(ScalarFrame< T >&& buf,
+                    int threads = 1,
+                    bool finite = false,
+                    const ScalarRange< double >* range = nullptr) {
+    if(buf.empty()) throw std::runtime_error("Empty file");
+    if(range) {
+        return make_tuple(std::move(buf), ClampTo< T >(range->min),
+                          ClampTo< T >(range->max));
+    }
+    const ScalarRange< T > r = MinMax(buf.begin(), buf.end(), threads,
+                                      finite);
+    if(!r.count) throw std::runtime_error("No valid values in file");
+    return make_tuple(std::move(buf), r.min, r.max);
 }
 
-string FrameNumToString(int f, int endFrame) {
+///Output file name of frame @c f stored into @c name, whose memory is reused:
+///prefix followed by the frame number zero padded to the number of digits of
+///the last frame and by the extension, if not empty
+void OutputFileName(const string& prefix, int f, int endFrame,
+                    const char* extension, string& name) {
     int totalDigits = 1;
     while(endFrame /= 10) ++totalDigits;
     int fr = f;
     int fdigits = 1;
     while(fr /= 10) ++fdigits;
-    ostringstream oss;
-    for(int i = 0; i != (totalDigits - fdigits); ++i) oss << "0";
-    oss << f;
-    return oss.str();
+    name.assign(prefix);
+    if(totalDigits > fdigits) name.append(totalDigits - fdigits, '0');
+    name += to_string(f);
+    if(!*extension) return;
+    name += '.';
+    name += extension;
+}
+
+///One line summary of the encoding time
+void PrintEncodeStats(ostream& os, const string& format, const EncodeStats& s) {
+    os << format << " encoding: " << s.images << " images  "
+       << s.seconds << " s  ";
+    if(s.images) os << 1000.0 * s.seconds / double(s.images) << " ms/image  ";
+    if(s.seconds > 0.0) os << double(s.pixels) / s.seconds / 1e6
+                           << " Mpixel/s  ";
+    os << s.bytes << " bytes\n";
+}
+
+///One line summary of the frame reads
+void PrintReadStats(ostream& os, const char* method, const ReadStats& s) {
+    os << "read (" << method << "): " << s.frames << " frames  "
+       << s.seconds << " s  ";
+    if(s.seconds > 0.0) os << s.Bandwidth() / 1e6 << " MB/s  ";
+    os << s.bytes << " bytes  " << s.stalled << " s waiting for data\n";
 }
     
 //------------------------------------------------------------------------------
-int main(int argc, char** argv) {
-    if(argc < 8) {
-        std::cout << "\nusage: " 
-                  << argv[0]
+///Parsed colormaps, lookup tables and image writers: built once per run or,
+///with -serve, kept across the jobs of the daemon
+struct Resources {
+    SharedCache< KeyData > colormaps;
+    SharedCache< ColormapLUT > luts;
+    SharedCache< ColormapKernel > kernels;
+    KeyedPool< ImageWriter > writers;
+};
+
+///Image writer configured by @c o, with its encoder handle and buffers
+///reused from a previous frame or job if available; encoding statistics
+///start from zero
+KeyedPool< ImageWriter >::Lease AcquireWriter(const ImageOptions& o,
+                                              Resources& r) {
+    KeyedPool< ImageWriter >::Lease w =
+        r.writers.Get(o.Key(), [&o]() { return MakeImageWriter(o); });
+    w->ResetStats();
+    return w;
+}
+
+//------------------------------------------------------------------------------
+///-range global: one data range for all the frames
+struct GlobalRangeOptions {
+    ///low and high percentiles mapped to the colormap ends, empty = min and
+    ///max
+    std::vector< double > percentiles;
+    ///range index file, the frame ranges and percentiles are cached across
+    ///runs
+    string index;
+};
+
+///Parsed command line and colormap, shared by all the Render instances
+struct Config {
+    const string& path;
+    const string& prefix;
+    const string& suffix;
+    int startFrame;
+    int endFrame;
+    int width;
+    int height;
+    const std::vector< Vector3D< double > >& colors;
+    const std::vector< double >& keys;
+    bool cubicInterpolation;
+    bool hsv;
+    bool exact;
+    double normFactor;
+    const ColormapLUT& lut;
+    const ColormapKernel& exactKernel;
+    ///-exact with a built-in colormap: kernel specialized for the map at
+    ///compile time, nullptr = exactKernel
+    BuiltinColormap::MapFunction staticKernel;
+    bool stat;
+    bool json;
+    const StatisticsOptions& statOptions;
+    bool finite;
+    int threads;
+    int frameThreads;
+    bool swapBytes;
+    ///single file input: the frames are the slices of the volume stored in
+    ///volumeFile, nullptr = one file per frame
+    const string& volumeFile;
+    const VolumeLayout* volume;
+    ///fixed data range, nullptr = range of each frame
+    const ScalarRange< double >* range;
+    ///range of all the frames computed before rendering, nullptr = range
+    ///or range of each frame
+    const GlobalRangeOptions* globalRange;
+    ///rows per strip in streaming mode, 0 = whole frames
+    int streamRows;
+    ///frames read ahead asynchronously into pooled buffers, 0 = frames are
+    ///memory mapped
+    int prefetch;
+    const ImageOptions& image;
+    ///print encoding time
+    bool timing;
+    ///indexed color output: palette indices instead of RGB, nullptr = RGB
+    const ColormapLUT* palette;
+    ///tiled multi-resolution output, nullptr = one image per frame
+    const PyramidOptions* pyramid;
+    ///output image size different from the input one, nullptr = same size
+    const ResampleOptions* resample;
+    ///statistics and diagnostics output
+    ostream& out;
+    ostream& err;
+    Resources& resources;
+    int ImageWidth() const { return resample ? resample->width : width; }
+    int ImageHeight() const { return resample ? resample->height : height; }
+    ///Name of the input of frame @c f in statistics
+    string InputName(int f) const {
+        if(volume) {
+            return volumeFile + ':' + "xyz"[volume->axis] + '='
+                   + to_string(f);
+        }
+        return path + prefix + to_string(f) + suffix;
+    }
+};
+
+//------------------------------------------------------------------------------
+///Colorization of frames with data range [minVal, maxVal] with the method
+///selected on the command line, called on blocks of the frame; with -stat the
+///single pass statistics are accumulated at the same time
+template < typename T >
+class FrameColorizer {
+public:
+    ///@c tableBuffer holds the integer table if any, it is reused across
+    ///frames
+    FrameColorizer(const Config& c, T minVal, T maxVal,
+                   std::vector< ColorType >& tableBuffer)
+        : c_(c), min_(minVal), max_(maxVal),
+          acc_(double(minVal), double(maxVal), c.statOptions.bins,
+               c.statOptions.finite),
+          colorizer_(c.lut, minVal, maxVal, c.exact, tableBuffer) {}
+    void operator()(const T* b, const T* e, ColorType* out) {
+        if(c_.stat) acc_.Add(b, e);
+        colorizer_.Map(b, e, out, [this](const double* db, const double* de,
+                                         ColorType* o, double mn, double mx) {
+            if(c_.staticKernel) {
+                c_.staticKernel(db, de, o, mn, mx);
+            } else {
+                c_.exactKernel.Map(db, de, o, mn, mx);
+            }
+        });
+    }
+    ///Palette indices of [b, e) into out
+    void Index(const T* b, const T* e, unsigned char* out) {
+        if(c_.stat) acc_.Add(b, e);
+        c_.palette->MapIndex(b, e, out, min_, max_);
+    }
+    void Get(FrameStatistics& s) const { acc_.Get(s); }
+private:
+    const Config& c_;
+    T min_;
+    T max_;
+    StatisticsAccumulator acc_;
+    RangeColorizer< T > colorizer_;
+};
+
+//------------------------------------------------------------------------------
+///Colorize the @c n scalars of an image into @c pic, RGB or palette indices
+template < typename T >
+void ColorizeImage(const Config& c, const T* data, size_t n,
+                   FrameColorizer< T >& kernel,
+                   std::vector< ColorType >& pic) {
+    if(c.palette) {
+        //one byte per pixel, the RGB image is never built
+        pic.resize(n);
+        ParallelFor(n, 1 << 16, c.frameThreads, [&](size_t b, size_t e) {
+            kernel.Index(data + b, data + e, pic.data() + b);
+        });
+    } else {
+        pic.resize(3 * n);
+        ParallelScalarToRGB(data, n, pic.data(), size_t(c.ImageWidth()),
+                            c.frameThreads, std::ref(kernel));
+    }
+}
+
+//------------------------------------------------------------------------------
+///Input frames: one mapped file per frame or slices of a volume mapped once
+template < typename T >
+class FrameInput {
+public:
+    explicit FrameInput(const Config& c)
+        : c_(c), volume_(c.volume ? Volume< T >(c.volumeFile, *c.volume,
+                                                c.swapBytes)
+                                  : Volume< T >()) {}
+    ///Frame @c f; @c inName is reused across frames
+    ScalarFrame< T > Frame(int f, string& inName) const {
+        if(c_.volume) return volume_.Slice(size_t(f));
+        FrameFileName(c_.path, c_.prefix, f, c_.suffix, inName);
+        return ScalarFrame< T >(inName, c_.swapBytes, c_.frameThreads);
+    }
+    ///File frame @c f is read from
+    string File(int f) const {
+        return c_.volume ? c_.volumeFile
+                         : FrameFileName(c_.path, c_.prefix, f, c_.suffix);
+    }
+    ///Frame @c f and how its values are read: element type, byte order,
+    ///-finite, volume layout
+    string Id(int f) const {
+        ostringstream os;
+        os << (is_floating_point< T >::value ? 'f'
+               : is_signed< T >::value ? 'i' : 'u')
+           << 8 * sizeof(T) << ' ' << c_.swapBytes << ' ' << c_.finite;
+        if(c_.volume) {
+            const VolumeLayout& l = *c_.volume;
+            os << ' ' << l.offset;
+            for(int i = 0; i != 3; ++i)
+                os << ' ' << l.extent[i] << ' ' << l.stride[i];
+        }
+        os << ' ' << c_.InputName(f);
+        return os.str();
+    }
+private:
+    const Config& c_;
+    const Volume< T > volume_;
+};
+
+//------------------------------------------------------------------------------
+///Number of bins of the histogram of all the frames percentiles are computed
+///from, see HistogramPercentile
+static const size_t RANGE_HISTOGRAM_BINS = 1 << 16;
+
+///-range global: range of all the frames. Frame ranges are computed in
+///parallel, one frame per thread, unless the range index has them for the
+///same file size and modification time. With percentiles, the histogram of
+///all the frames over their range is computed in a second pass, unless the
+///index has the percentiles for the same frames
+template < typename T >
+ScalarRange< double > SequenceRange(const Config& c) {
+    const auto start = chrono::steady_clock::now();
+    const GlobalRangeOptions& o = *c.globalRange;
+    const FrameInput< T > input(c);
+    RangeIndex index(o.index);
+    const size_t frames = size_t(c.endFrame - c.startFrame + 1);
+    vector< string > ids(frames);
+    vector< FileKey > keys(frames);
+    vector< ScalarRange< double > > ranges(frames);
+    vector< char > cached(frames);
+    size_t hits = 0;
+    for(size_t i = 0; i != frames; ++i) {
+        const int f = c.startFrame + int(i);
+        ids[i] = input.Id(f);
+        keys[i] = FileKey::Of(input.File(f));
+        cached[i] = index.Get(ids[i], keys[i], ranges[i]);
+        hits += cached[i];
+    }
+    //all the threads go to the frames, or to the single frame to scan
+    const int frameThreads = frames - hits > 1 ? 1 : c.threads;
+    ParallelFor(frames, 1, c.threads, [&](size_t b, size_t e) {
+        string inName;
+        for(size_t i = b; i != e; ++i) {
+            if(cached[i]) continue;
+            const ScalarFrame< T > d = input.Frame(c.startFrame + int(i),
+                                                   inName);
+            const ScalarRange< T > r = MinMax(d.begin(), d.end(),
+                                              frameThreads, c.finite);
+            ranges[i].count = r.count;
+            if(r.count) {
+                ranges[i].min = double(r.min);
+                ranges[i].max = double(r.max);
+            }
+            index.Set(ids[i], keys[i], ranges[i]);
+        }
+    });
+    ScalarRange< double > r;
+    for(const ScalarRange< double >& fr: ranges) r.Merge(fr);
+    if(!r.count) throw std::runtime_error("No valid values in frames");
+    if(!o.percentiles.empty()) {
+        if(!std::isfinite(r.min) || !std::isfinite(r.max))
+            throw std::runtime_error("Infinite data range, use -finite");
+        std::uint64_t h = FNV1a(&r.min, sizeof(r.min));
+        h = FNV1a(&r.max, sizeof(r.max), h);
+        for(size_t i = 0; i != frames; ++i) {
+            h = FNV1a(ids[i].data(), ids[i].size(), h);
+            h = FNV1a(&keys[i], sizeof(keys[i]), h);
+        }
+        ScalarRange< double > pr = r;
+        if(!index.GetPercentile(h, o.percentiles[0], pr.min)
+           || !index.GetPercentile(h, o.percentiles[1], pr.max)) {
+            vector< size_t > histogram(RANGE_HISTOGRAM_BINS, 0);
+            mutex histogramMutex;
+            ParallelFor(frames, 1, c.threads, [&](size_t b, size_t e) {
+                string inName;
+                vector< size_t > fh(histogram.size(), 0);
+                for(size_t i = b; i != e; ++i) {
+                    const ScalarFrame< T > d =
+                        input.Frame(c.startFrame + int(i), inName);
+                    AddToHistogram(d.begin(), d.end(), r.min, r.max, fh);
+                }
+                lock_guard< mutex > lock(histogramMutex);
+                for(size_t k = 0; k != fh.size(); ++k) histogram[k] += fh[k];
+            });
+            pr.min = HistogramPercentile(histogram, r.min, r.max,
+                                         o.percentiles[0]);
+            pr.max = HistogramPercentile(histogram, r.min, r.max,
+                                         o.percentiles[1]);
+            index.SetPercentile(h, o.percentiles[0], pr.min);
+            index.SetPercentile(h, o.percentiles[1], pr.max);
+        }
+        r = pr;
+    }
+    try {
+        index.Save();
+    } catch(const std::exception&) {
+        c.err << "Cannot write range index " << o.index << '\n';
+    }
+    if(c.timing) {
+        const double s = chrono::duration< double >(
+                             chrono::steady_clock::now() - start).count();
+        c.err << "global range: [" << r.min << ", " << r.max << "]  "
+              << hits << '/' << frames << " frames from index  " << s
+              << " s\n";
+    }
+    return r;
+}
+
+//------------------------------------------------------------------------------
+///Colorize and save one frame a strip of rows at a time: at most one strip of
+///the input and of the output image is resident at any time, whatever the
+///frame size. The image is stored bottom-up in the file, the strips are read
+///from the end of the file.
+template < typename T >
+void StreamFrame(const Config& c, int f, const ScalarFrame< T >& d,
+                 const string& outName) {
+    const size_t rowSize = size_t(c.width);
+    if(d.size() < rowSize * size_t(c.height))
+        throw std::runtime_error("File smaller than image");
+    T m, M;
+    if(c.range) {
+        m = ClampTo< T >(c.range->min);
+        M = ClampTo< T >(c.range->max);
+    } else {
+        //pre-scan, strip by strip as well
+        ScalarRange< T > r;
+        const size_t blockSize = rowSize * size_t(c.streamRows);
+        for(const T* b = d.begin(); b < d.end(); b += blockSize) {
+            const T* e = min(b + blockSize, d.end());
+            r.Merge(MinMax(b, e, c.frameThreads, c.finite));
+            d.Release(b, e);
+        }
+        if(!r.count) throw std::runtime_error("No valid values in file");
+        m = r.min;
+        M = r.max;
+    }
+    std::vector< ColorType > integerTable;
+    FrameColorizer< T > colorize(c, m, M, integerTable);
+    JPEGStripWriter w(outName.c_str(), c.width, c.height, c.image.quality,
+                      c.image.subsampling);
+    std::vector< ColorType > strip(3 * rowSize * size_t(c.streamRows));
+    for(int top = c.height; top > 0; top -= c.streamRows) {
+        const int rows = min(top, c.streamRows);
+        const T* b = d.data() + rowSize * size_t(top - rows);
+        const T* e = b + rowSize * size_t(rows);
+        d.Prefetch(max(d.data(), b - (e - b)), b);
+        ParallelScalarToRGB(b, size_t(e - b), strip.data(), rowSize,
+                            c.frameThreads, std::ref(colorize));
+        w.WriteRows(strip.data(), rows, true);
+        d.Release(b, e);
+    }
+    w.Finish();
+    if(c.stat) {
+        FrameStatistics fs;
+        colorize.Get(fs);
+        const string name = c.InputName(f);
+        c.out << (c.json ? ToJSON(name, fs) : ToText(name, fs));
+    }
+}
+
+//------------------------------------------------------------------------------
+///Hash of everything but the data that affects the tiles: colormap, image
+///format and pyramid options
+std::uint64_t RenderHash(const Config& c) {
+    ostringstream os;
+    os.precision(17);
+    os << c.width << ' ' << c.height << ' ' << c.cubicInterpolation << ' '
+       << c.hsv << ' ' << c.exact << ' ' << c.normFactor << ' '
+       << c.image.format << ' ' << c.image.quality << ' '
+       << c.image.subsampling << ' ' << c.image.fastDCT << ' '
+       << c.image.pngLevel << ' ' << c.image.pngFilters << ' '
+       << c.image.lossless << ' ' << c.pyramid->scheme << ' '
+       << c.pyramid->aggregate << ' ' << c.pyramid->tileSize;
+    for(auto& v: c.colors) os << ' ' << v[0] << ' ' << v[1] << ' ' << v[2];
+    for(auto k: c.keys) os << ' ' << k;
+    const string s = os.str();
+    std::uint64_t h = FNV1a(s.data(), s.size());
+    if(!c.exact) h = FNV1a(c.lut.Data(), 3 * c.lut.Size(), h);
+    if(c.palette) h = FNV1a(c.palette->Data(), 3 * c.palette->Size(), h);
+    return h;
+}
+
+///Colorize and save the tiles of level @c l, in parallel; tiles whose data
+///and rendering parameters did not change since the last run are skipped.
+///@c data is the bottom-up level image
+template < typename T >
+void SavePyramidLevel(const Config& c, const TileLayout& layout, int l,
+                      const T* data, T minVal, T maxVal,
+                      std::uint64_t renderHash, TileIndex& index,
+                      EncodeStats& stats) {
+    const int width = layout.Width(l);
+    const int height = layout.Height(l);
+    const int columns = layout.Columns(l);
+    const int ts = layout.TileSize();
+    const size_t tiles = size_t(columns) * size_t(layout.Rows(l));
+    const size_t bpp = c.palette ? 1 : 3;
+    layout.CreateDirectories(l);
+    //statistics are computed once on the full resolution frame
+    Config tc = c;
+    tc.stat = false;
+    std::vector< std::uint64_t > hashes(tiles);
+    std::mutex statsMutex;
+    ParallelFor(tiles, max(size_t(1), tiles / (4 * size_t(c.frameThreads))),
+                c.frameThreads, [&](size_t b, size_t e) {
+        const KeyedPool< ImageWriter >::Lease w =
+            AcquireWriter(c.image, c.resources);
+        std::vector< ColorType > integerTable;
+        std::vector< ColorType > pic;
+        FrameColorizer< T > colorize(tc, minVal, maxVal, integerTable);
+        string name;
+        for(size_t t = b; t != e; ++t) {
+            const int col = int(t % columns);
+            const int row = int(t / columns);
+            const int x0 = col * ts;
+            const int y0 = row * ts;
+            const int tw = min(ts, width - x0);
+            const int th = min(ts, height - y0);
+            const int iw = layout.PadTiles() ? ts : tw;
+            const int ih = layout.PadTiles() ? ts : th;
+            //bottom row of the tile
+            const T* first = data + size_t(height - y0 - th) * width + x0;
+            std::uint64_t h = FNV1a(&minVal, sizeof(T), renderHash);
+            h = FNV1a(&maxVal, sizeof(T), h);
+            for(int k = 0; k != th; ++k)
+                h = FNV1a(first + size_t(k) * width, size_t(tw) * sizeof(T), h);
+            hashes[t] = h;
+            name = layout.TilePath(l, col, row);
+            if(index.Unchanged(l, col, row, h, name)) continue;
+            //padding below and right of the data
+            pic.assign(bpp * size_t(iw) * size_t(ih), 0);
+            for(int k = 0; k != th; ++k) {
+                const T* r = first + size_t(k) * width;
+                ColorType* out = pic.data() + bpp * size_t(ih - th + k) * iw;
+                if(c.palette) colorize.Index(r, r + tw, out);
+                else colorize(r, r + tw, out);
+            }
+            if(c.palette) {
+                w->SaveIndexed(iw, ih, name.c_str(), pic.data(),
+                               c.palette->Data(), int(c.palette->Size()));
+            } else w->Save(iw, ih, name.c_str(), pic);
+        }
+        std::lock_guard< std::mutex > lock(statsMutex);
+        stats.Merge(w->Stats());
+    });
+    for(size_t t = 0; t != tiles; ++t)
+        index.Set(l, int(t % columns), int(t / columns), hashes[t]);
+}
+
+///Save frame @c f as a pyramid of tiles: the levels are computed from the
+///full resolution frame by repeated halving in scalar space, only two levels
+///are in memory at any time, the full resolution one is the mapped file.
+///All the levels are colorized with the data range of the full resolution
+///frame
+template < typename T >
+void SavePyramid(const Config& c, int f, const Data< T >& data,
+                 EncodeStats& stats) {
+    const ScalarFrame< T >& d = get<DATASET>(data);
+    if(d.size() < size_t(c.width) * size_t(c.height))
+        throw std::runtime_error("File smaller than image");
+    const T m = get<DATASET_MIN>(data);
+    const T M = get<DATASET_MAX>(data);
+    string base;
+    OutputFileName(c.prefix, f, c.endFrame, "", base);
+    const TileLayout layout(c.pyramid->scheme, base, c.width, c.height,
+                            c.pyramid->tileSize,
+                            AcquireWriter(c.image, c.resources)->Extension());
+    const std::uint64_t renderHash = RenderHash(c);
+    TileIndex index(layout.IndexPath());
+    const int top = layout.Levels() - 1;
+    SavePyramidLevel(c, layout, top, d.data(), m, M, renderHash, index, stats);
+    std::vector< double > level;
+    std::vector< double > next;
+    for(int l = top - 1; l >= 0; --l) {
+        if(l == top - 1) {
+            Downsample2(d.data(), c.width, c.height, level,
+                        c.pyramid->aggregate, c.frameThreads);
+        } else {
+            Downsample2(level.data(), layout.Width(l + 1),
+                        layout.Height(l + 1), next, c.pyramid->aggregate,
+                        c.frameThreads);
+            level.swap(next);
+        }
+        SavePyramidLevel(c, layout, l, level.data(), double(m), double(M),
+                         renderHash, index, stats);
+    }
+    layout.WriteDescriptor();
+    index.Save();
+}
+
+//------------------------------------------------------------------------------
+///Read, colorize and save all the frames, data elements are of type T.
+///The image, compressed image and file name buffers are reused across frames:
+///in the sequential path, without -stat, frames after the first one do not
+///allocate.
+template < typename T >
+void Render(const Config& c) {
+    if(c.globalRange) {
+        const ScalarRange< double > range = SequenceRange< T >(c);
+        Config gc = c;
+        gc.range = &range;
+        gc.globalRange = nullptr;
+        Render< T >(gc);
+        return;
+    }
+    const FrameInput< T > input(c);
+    //-prefetch: the next frames are read while the current ones are
+    //processed, the buffers go back to the reader once colorized
+    std::unique_ptr< FrameReader< T > > reader;
+    if(c.prefetch > 0) {
+        reader.reset(new FrameReader< T >([&c](int f, string& name) {
+            FrameFileName(c.path, c.prefix, f, c.suffix, name);
+        }, c.startFrame, c.endFrame, c.prefetch));
+    }
+    //compressed frames are decompressed by the thread reading them, in the
+    //pipeline while the previous frames are colorized; the compressed
+    //buffers go back to the reader right away
+    const bool compressed = IsGzipFile(c.suffix);
+    ObjectPool< std::vector< T > > decompressed;
+    auto read = [&](int f, string& inName) {
+        if(!reader) {
+            return FrameData(input.Frame(f, inName), c.frameThreads,
+                             c.finite, c.range);
+        }
+        size_t bytes = 0;
+        std::vector< T > b = reader->Get(f, &bytes);
+        if(compressed) {
+            std::vector< T > d = decompressed.Get();
+            Gunzip(reinterpret_cast< const char* >(b.data()), bytes, d,
+                   c.frameThreads);
+            reader->Recycle(std::move(b));
+            b = std::move(d);
+        } else b.resize(bytes / sizeof(T));
+        return FrameData(ScalarFrame< T >(std::move(b), c.swapBytes),
+                         c.frameThreads, c.finite, c.range);
+    };
+    auto recycle = [&](Data< T >& data) {
+        if(!reader) return;
+        if(compressed) decompressed.Put(get<DATASET>(data).TakeBuffer());
+        else reader->Recycle(get<DATASET>(data).TakeBuffer());
+    };
+    auto printReadStats = [&]() {
+        if(c.timing && reader)
+            PrintReadStats(c.err, reader->Method(), reader->Stats());
+    };
+    if(c.streamRows > 0) {
+        string inName;
+        string outName;
+        for(int f = c.startFrame; f != c.endFrame + 1; ++f) {
+            OutputFileName(c.prefix, f, c.endFrame, "jpg", outName);
+            StreamFrame< T >(c, f, input.Frame(f, inName), outName);
+        }
+        return;
+    }
+    if(c.pyramid) {
+        EncodeStats stats;
+        string inName;
+        for(int f = c.startFrame; f != c.endFrame + 1; ++f) {
+            Data< T > data = read(f, inName);
+            if(c.stat) {
+                const ScalarFrame< T >& d = get<DATASET>(data);
+                const FrameStatistics fs =
+                    Statistics(d.begin(), d.end(),
+                               double(get<DATASET_MIN>(data)),
+                               double(get<DATASET_MAX>(data)), c.statOptions);
+                const string name = c.InputName(f);
+                c.out << (c.json ? ToJSON(name, fs) : ToText(name, fs));
+            }
+            SavePyramid(c, f, data, stats);
+            recycle(data);
+        }
+        if(c.timing) PrintEncodeStats(c.err, c.image.format, stats);
+        printReadStats();
+        return;
+    }
+    //per-frame stages, shared by the sequential and the pipelined paths
+    //with -stat the statistics text is returned in statText; with -resize
+    //the frame is resampled into scaled first and the statistics are those
+    //of the input frame
+    auto colorize = [&](int f, const Data< T >& data,
+                        std::vector< ColorType >& pic,
+                        std::vector< ColorType >& integerTable,
+                        std::vector< double >& scaled,
+                        string& statText) {
+        const ScalarFrame< T >& d = get<DATASET>(data);
+        const T m = get<DATASET_MIN>(data);
+        const T M = get<DATASET_MAX>(data);
+        FrameStatistics fs;
+        if(c.resample) {
+            if(d.size() < size_t(c.width) * size_t(c.height))
+                throw std::runtime_error("File smaller than image");
+            Resample(d.data(), c.width, c.height, *c.resample, scaled,
+                     c.frameThreads);
+            Config tc = c;
+            tc.stat = false;
+            FrameColorizer< double > kernel(tc, double(m), double(M),
+                                            integerTable);
+            ColorizeImage(c, scaled.data(), scaled.size(), kernel, pic);
+            if(c.stat) fs = Statistics(d.begin(), d.end(), double(m),
+                                       double(M), c.statOptions);
+        } else {
+            FrameColorizer< T > kernel(c, m, M, integerTable);
+            ColorizeImage(c, d.data(), d.size(), kernel, pic);
+            if(c.stat) {
+                kernel.Get(fs);
+                if(c.statOptions.SortRequired())
+                    SortedStatistics(d.begin(), d.end(), c.statOptions, fs);
+            }
+        }
+        if(c.stat) {
+            const string name = c.InputName(f);
+            statText = c.json ? ToJSON(name, fs) : ToText(name, fs);
+        }
+    };
+    auto save = [&](ImageWriter& w, const string& outName,
+                    const std::vector< ColorType >& pic) {
+        if(c.palette) {
+            w.SaveIndexed(c.ImageWidth(), c.ImageHeight(), outName.c_str(),
+                          pic.data(), c.palette->Data(),
+                          int(c.palette->Size()));
+        } else w.Save(c.ImageWidth(), c.ImageHeight(), outName.c_str(), pic);
+    };
+    if(c.threads < 2 || c.startFrame == c.endFrame) {
+        const KeyedPool< ImageWriter >::Lease w =
+            AcquireWriter(c.image, c.resources);
+        std::vector< ColorType > pic;
+        std::vector< ColorType > integerTable;
+        std::vector< double > scaled;
+        string inName;
+        string outName;
+        string statText;
+        for(int f = c.startFrame; f != c.endFrame + 1; ++f) {
+#ifdef SCOLOR_COUNT_ALLOCATIONS
+            const size_t allocations = AllocationCount();
+#endif
+            OutputFileName(c.prefix, f, c.endFrame, w->Extension(), outName);
+            Data< T > data = read(f, inName);
+            colorize(f, data, pic, integerTable, scaled, statText);
+            recycle(data);
+            c.out << statText;
+            save(*w, outName, pic);
+#ifdef SCOLOR_COUNT_ALLOCATIONS
+            c.err << outName << ": " << AllocationCount() - allocations
+                 << " allocations\n";
+#endif
+        }
+        if(c.timing) PrintEncodeStats(c.err, c.image.format, w->Stats());
+        printReadStats();
+    } else {
+        //reader thread + colorize and encode pools, each encoder thread
+        //owns its own ImageWriter; the images are returned to a pool once
+        //encoded
+        const int colorizeThreads = max(1, c.threads / 2);
+        const int encodeThreads = max(1, c.threads - colorizeThreads);
+        std::vector< KeyedPool< ImageWriter >::Lease > writers;
+        for(int i = 0; i != encodeThreads; ++i)
+            writers.push_back(AcquireWriter(c.image, c.resources));
+        OrderedOutput statOut(c.out, c.startFrame);
+        ObjectPool< std::vector< ColorType > > images;
+        ObjectPool< std::vector< ColorType > > integerTables;
+        ObjectPool< std::vector< double > > scaledFrames;
+        FramePipeline(
+            c.startFrame, c.endFrame, colorizeThreads, encodeThreads,
+            size_t(2 * c.threads),
+            [&](int f) {
+                string inName;
+                return read(f, inName);
+            },
+            [&](int f, Data< T >&& data) {
+                string statText;
+                std::vector< ColorType > pic = images.Get();
+                std::vector< ColorType > integerTable = integerTables.Get();
+                std::vector< double > scaled = scaledFrames.Get();
+                colorize(f, data, pic, integerTable, scaled, statText);
+                recycle(data);
+                integerTables.Put(std::move(integerTable));
+                scaledFrames.Put(std::move(scaled));
+                statOut.Put(f, statText);
+                return pic;
+            },
+            [&](int i, int f, std::vector< ColorType >&& pic) {
+                ImageWriter& w = *writers[i];
+                string outName;
+                OutputFileName(c.prefix, f, c.endFrame, w.Extension(),
+                               outName);
+                save(w, outName, pic);
+                images.Put(std::move(pic));
+            });
+        if(c.timing) {
+            EncodeStats stats;
+            for(auto& w: writers) stats.Merge(w->Stats());
+            PrintEncodeStats(c.err, c.image.format, stats);
+        }
+        printReadStats();
+    }
+}
+
+//------------------------------------------------------------------------------
+///Parse the command line @c args, args[0] being the program name, and render
+///the frames; statistics go to @c out, diagnostics to @c err. Returns the
+///exit status
+int Run(const vector< string >& args, ostream& out, ostream& err,
+        Resources& resources) {
+    if(args.size() < 8) {
+        out << "\nusage: " 
+                  << args[0] << " -serve [<socket path>]\n       "
+                  << args[0]
                   << "  <path> <prefix>"
                      "  <start frame #> <end frame #>"
                      " <suffix> <width> <height> [-cubic] [-dist] "
-                     "[-f filename [-csv] [-norm]] [-stat]\n";
-        std::cout << "-hsv: input is in HSV format\n" 
+                     "[-f filename [-csv] [-norm] | -map <name>] "
+                     "[-stat | -json [-hist <bins>] [-ahist <bins>] [-pct <p1,p2...>]] "
+                     "[-exact | -lutsize <size> [-lutends]] [-j <threads>] "
+                     "[-jf <threads>] [-finite] [-type <type>] [-endian big|little] "
+                     "[-range <min> <max> | -range global [-rangepct <low> <high>] "
+                     "[-rangeindex <file>]] [-stream <rows>] [-prefetch <frames>] "
+                     "[-volume <file> <depth> [-axis x|y|z] [-offset <bytes>] "
+                     "[-stride <x> <y> <z>]] "
+                     "[-format jpg|png|webp|gif|bmp|ppm|raw] [-quality <q>] "
+                     "[-subsamp 444|422|420|gray] [-fastdct] [-pnglevel <level>] "
+                     "[-pngfilter none|sub|up|avg|paeth|all] [-lossless] [-timing] "
+                     "[-palette <size>|steps] [-je <threads>] "
+                     "[-pyramid dzi|xyz [-tile <size>] [-aggregate mean|max]] "
+                     "[-resize <width> <height> [-filter box|bilinear|max]]\n";
+        out << "Frame files ending in .gz are gzip compressed; BGZF files (bgzip)\n"
+                  << "are decompressed in parallel by the -jf threads\n"
+                  << "-hsv: input is in HSV format\n" 
                   << "-cubic: use Catmull-Rom interpolation, default is linear\n"
                   << "-dist:  parameterization is proportional to (chord length)^2, default il uniform\n"
                   << "-csv:   keyfranmes in csv format: t,R,G,B first line skipped\n"
                   << "-norm:  force division by 255\n"
-                  << "-stat:  print min, max, num levels and value with max num levels\n";            
+                  << "-map:   built-in colormap compiled into the executable, no file\n"
+                  << "        is read; with -exact the colormap is evaluated by a kernel\n"
+                  << "        specialized for it. -hsv and -dist do not apply, maps:\n"
+                  << "       ";
+        for(const BuiltinColormap& m: BuiltinColormaps()) out << ' ' << m.name;
+        out << "\n"
+                  << "-stat:  print min, max, num levels, value with max num levels, mean\n"
+                  << "        and standard deviation of each frame\n"
+                  << "-json:  same as -stat in JSON format, one object per line\n"
+                  << "-hist:  add histogram with <bins> fixed width bins to statistics\n"
+                  << "-ahist: add edges of <bins> equal count bins to statistics\n"
+                  << "-pct:   add comma separated list of percentiles to statistics\n"
+                  << "-exact: evaluate the colormap at each pixel instead of using a lookup table\n"
+                  << "-lutsize: number of lookup table entries, default is "
+                  << ColormapLUT::DEFAULT_SIZE << "\n"
+                  << "-lutends: map min and max values to the exact end colors\n"
+                  << "-j:     number of threads used to read, colorize and encode frames\n"
+                  << "        concurrently, 0 = number of cores; default is 1\n"
+                  << "-jf:    number of threads used to colorize each frame, 0 = number\n"
+                  << "        of cores; default is the -j value for a single frame, 1 otherwise\n"
+                  << "-finite: ignore infinite values when computing the data range\n"
+                  << "        and statistics, NaNs are always ignored\n"
+                  << "-type:  input element type: f64 (default), f32, u8, u16, i16, i32\n"
+                  << "-endian: input byte order, default is the host one\n"
+                  << "-range: map [min, max] to the colormap instead of the range of each\n"
+                  << "        frame, skips the min/max pass; with global the range of\n"
+                  << "        all the frames, computed in parallel before rendering\n"
+                  << "-rangepct: with -range global, map the <low> and <high>\n"
+                  << "        percentiles of all the frames, in [0, 100], instead of the\n"
+                  << "        min and max; computed on a histogram of "
+                  << RANGE_HISTOGRAM_BINS << " bins\n"
+                  << "-rangeindex: file caching the frame ranges and percentiles\n"
+                  << "        across runs, valid while the size and modification time of\n"
+                  << "        the files do not change; default is <path>/<prefix>range.idx\n"
+                  << "        or, with -volume, <file>.range.idx\n"
+                  << "-volume: read the frames from a single file holding a\n"
+                  << "        <width> x <height> x <depth> volume or time series, x\n"
+                  << "        varying fastest; the frames are the slices perpendicular\n"
+                  << "        to the axis, <path> and <suffix> are not used. Slices\n"
+                  << "        contiguous in the file are not copied\n"
+                  << "-axis:  slice axis, default is z: images are width x height\n"
+                  << "        (z), width x depth (y) or height x depth (x)\n"
+                  << "-offset: bytes before the first element, e.g. a header\n"
+                  << "-stride: distance in elements between consecutive elements\n"
+                  << "        along x, y and z, for padded or transposed layouts;\n"
+                  << "        default is 1, width, width * height\n"
+                  << "-stream: colorize and encode frames in strips of <rows> rows, memory\n"
+                  << "        use is bounded by the strip size; frames are processed one at\n"
+                  << "        a time and -ahist, -pct and levels are not computed. Without\n"
+                  << "        -range the data is read twice. Byte swapped input is still\n"
+                  << "        copied and compressed input decompressed in full; JPEG\n"
+                  << "        output only\n"
+                  << "-prefetch: read the next <frames> frames while the current\n"
+                  << "        ones are processed, opened and read through io_uring or, if\n"
+                  << "        not available, threads; frames are read into reused buffers\n"
+                  << "        instead of being memory mapped, compressed frames are\n"
+                  << "        decompressed after the read. With -timing the read\n"
+                  << "        bandwidth is printed\n"
+                  << "-format: jpg, png, webp, gif, bmp, ppm or raw (headerless RGB); default is jpg\n"
+                  << "-quality: JPEG and lossy WebP quality, default is 100\n"
+                  << "-subsamp: JPEG chroma subsampling, default is 444\n"
+                  << "-fastdct: faster, less accurate JPEG DCT\n"
+                  << "-pnglevel: PNG zlib compression level, 0 to 9\n"
+                  << "-pngfilter: PNG row filter, default is all (adaptive)\n"
+                  << "-lossless: lossless WebP\n"
+                  << "-timing: print the time spent encoding images\n"
+                  << "-palette: write 8 bit indexed images (png, gif, bmp): scalars are\n"
+                  << "        mapped to one of <size> <= 256 colors sampled from the\n"
+                  << "        colormap; with steps the palette is the colormap colors, for\n"
+                  << "        discrete colormaps\n"
+                  << "-je:    number of threads encoding each JPEG image, in strips joined\n"
+                  << "        through restart markers; 0 = number of cores, default is 1\n"
+                  << "-pyramid: write each frame as a multi-resolution pyramid of tiles,\n"
+                  << "        DeepZoom (<name>.dzi and <name>_files/<level>/<col>_<row>) or\n"
+                  << "        XYZ (<name>/<z>/<x>/<y>); tiles whose data did not change since\n"
+                  << "        the last run are not written again\n"
+                  << "-tile:  tile size, default is 256\n"
+                  << "-aggregate: reduction of 2x2 blocks of scalars into the lower\n"
+                  << "        resolution levels, default is mean\n"
+                  << "-resize: resample each frame to <width> x <height> before\n"
+                  << "        colorization, e.g. for thumbnails; statistics are computed\n"
+                  << "        on the input frame\n"
+                  << "-filter: resampling filter: box (mean, default), bilinear or max\n"
+                  << "-serve: daemon mode, run jobs read from stdin or from the\n"
+                  << "        connections to a Unix domain socket, one job per line with\n"
+                  << "        the same arguments as the command line; each job output is\n"
+                  << "        followed by OK or ERROR. Colormaps, lookup tables and\n"
+                  << "        encoders are kept across jobs, paths are relative to the\n"
+                  << "        daemon working directory; up to 16 socket connections are\n"
+                  << "        served at a time\n";
 
         return 1;
     }
-    const string path = argv[1];
-    const string prefix = argv[2];
-    const string suffix = argv[5];
-    const int startFrame = stoi(argv[3]); //throws if arg not valid
-    const int endFrame   = stoi(argv[4]); //throws if arg not valid
-    const int width = stoi(argv[6]);
-    const int height = stoi(argv[7]);
-    std::vector< Vector3D< double > > colors;
-    vector< string > args(argv, argv + argc);
+    const string path = args[1];
+    const string prefix = args[2];
+    const string suffix = args[5];
+    const int startFrame = stoi(args[3]); //throws if arg not valid
+    const int endFrame   = stoi(args[4]); //throws if arg not valid
+    int width = stoi(args[6]);
+    int height = stoi(args[7]);
     const bool distanceParameterization = find(args.begin(), args.end(), "-dist")
                                           != args.end();
     const bool csv = find(args.begin(), args.end(), "-csv") != args.end();
     const double norm = find(args.begin(), args.end(), "-norm") != args.end() ? 1./255. : 1.;
-    const bool stat = find(args.begin(), args.end(), "-stat") != args.end();
+    const bool stat = find(args.begin(), args.end(), "-stat") != args.end()
+                      || find(args.begin(), args.end(), "-json") != args.end();
     const bool cubicInterpolation = find(args.begin(), args.end(), "-cubic") != args.end();
-    const bool hsv = find(args.begin(), args.end(), "-hsv") != args.end();
-    vector< double > keyframes;
-    if(find(args.begin(), args.end(), "-f") != args.end()
+    //built-in colormap: colors, keys and color space compiled in
+    const BuiltinColormap* builtinMap = nullptr;
+    if(find(args.begin(), args.end(), "-map") != args.end()
+       && ++find(args.begin(), args.end(), "-map") != args.end()) {
+        builtinMap = FindBuiltinColormap(*++find(args.begin(), args.end(),
+                                                 "-map"));
+        if(!builtinMap) {
+            err << "Unknown colormap, available colormaps:";
+            for(const BuiltinColormap& m: BuiltinColormaps())
+                err << ' ' << m.name;
+            err << std::endl;
+            return -1;
+        }
+    }
+    const bool hsv = builtinMap ? builtinMap->hsv
+                     : find(args.begin(), args.end(), "-hsv") != args.end();
+    const bool exact = find(args.begin(), args.end(), "-exact") != args.end();
+    const bool lutEnds = find(args.begin(), args.end(), "-lutends") != args.end();
+    const bool finite = find(args.begin(), args.end(), "-finite") != args.end();
+    const bool json = find(args.begin(), args.end(), "-json") != args.end();
+    string type = "f64";
+    if(find(args.begin(), args.end(), "-type") != args.end()
+       && ++find(args.begin(), args.end(), "-type") != args.end()) {
+        type = *++find(args.begin(), args.end(), "-type");
+    }
+    bool swapBytes = false;
+    if(find(args.begin(), args.end(), "-endian") != args.end()
+       && ++find(args.begin(), args.end(), "-endian") != args.end()) {
+        const string e = *++find(args.begin(), args.end(), "-endian");
+        if(e != "big" && e != "little") {
+            err << "Invalid endianness " << e << std::endl;
+            return -1;
+        }
+        swapBytes = (e == "big") != HostIsBigEndian();
+    }
+    ScalarRange< double > range;
+    bool fixedRange = false;
+    GlobalRangeOptions globalRange;
+    const bool sequenceRange = find(args.begin(), args.end(), "-range")
+                               != args.end()
+                               && ++find(args.begin(), args.end(), "-range")
+                                  != args.end()
+                               && *++find(args.begin(), args.end(), "-range")
+                                  == "global";
+    if(find(args.begin(), args.end(), "-rangepct") != args.end()) {
+        auto i = find(args.begin(), args.end(), "-rangepct");
+        if(args.end() - i < 3 || !sequenceRange) {
+            err << "Invalid -rangepct, requires -range global" << std::endl;
+            return -1;
+        }
+        const double low = stod(*++i);
+        const double high = stod(*++i);
+        if(!(low >= 0. && low < high && high <= 100.)) {
+            err << "Invalid percentiles" << std::endl;
+            return -1;
+        }
+        globalRange.percentiles = {low, high};
+    }
+    if(find(args.begin(), args.end(), "-rangeindex") != args.end()
+       && ++find(args.begin(), args.end(), "-rangeindex") != args.end()) {
+        globalRange.index = *++find(args.begin(), args.end(), "-rangeindex");
+    }
+    if(!sequenceRange && find(args.begin(), args.end(), "-range") != args.end()
+       && args.end() - find(args.begin(), args.end(), "-range") > 2) {
+        auto i = find(args.begin(), args.end(), "-range");
+        range.min = stod(*++i);
+        range.max = stod(*++i);
+        if(!(range.max >= range.min)) {
+            err << "Invalid range" << std::endl;
+            return -1;
+        }
+        fixedRange = true;
+    }
+    //single file volume: width x height x depth, frames are slices along
+    //the axis, the image size is the size of the slices
+    string volumeFile;
+    VolumeLayout volume;
+    const bool sliced = find(args.begin(), args.end(), "-volume") != args.end();
+    if(sliced) {
+        auto i = find(args.begin(), args.end(), "-volume");
+        if(args.end() - i < 3 || stoi(*(i + 2)) < 1 || width < 1
+           || height < 1) {
+            err << "Invalid volume" << std::endl;
+            return -1;
+        }
+        volumeFile = *++i;
+        volume.extent[0] = size_t(width);
+        volume.extent[1] = size_t(height);
+        volume.extent[2] = size_t(stoi(*++i));
+        volume.ContiguousStrides();
+    }
+    if(find(args.begin(), args.end(), "-axis") != args.end()
+       && ++find(args.begin(), args.end(), "-axis") != args.end()) {
+        const string a = *++find(args.begin(), args.end(), "-axis");
+        if(a == "x") volume.axis = 0;
+        else if(a == "y") volume.axis = 1;
+        else if(a == "z") volume.axis = 2;
+        else {
+            err << "Invalid axis " << a << std::endl;
+            return -1;
+        }
+    }
+    if(find(args.begin(), args.end(), "-offset") != args.end()
+       && ++find(args.begin(), args.end(), "-offset") != args.end()) {
+        volume.offset = stoull(*++find(args.begin(), args.end(), "-offset"));
+    }
+    if(find(args.begin(), args.end(), "-stride") != args.end()) {
+        auto i = find(args.begin(), args.end(), "-stride");
+        if(args.end() - i < 4) {
+            err << "Invalid stride" << std::endl;
+            return -1;
+        }
+        for(size_t& s: volume.stride) s = stoull(*++i);
+    }
+    if(sliced) {
+        if(startFrame < 0 || endFrame < startFrame
+           || size_t(endFrame) >= volume.Slices()) {
+            err << "Frames out of volume, " << volume.Slices()
+                << " slices along " << "xyz"[volume.axis] << std::endl;
+            return -1;
+        }
+        width = int(volume.Width());
+        height = int(volume.Height());
+    }
+    //default range index: next to the input
+    if(sequenceRange && globalRange.index.empty()) {
+        if(sliced) globalRange.index = volumeFile + ".range.idx";
+        else {
+            globalRange.index = path;
+            if(path.empty() || path[path.size() - 1] != '/')
+                globalRange.index += '/';
+            globalRange.index += prefix + "range.idx";
+        }
+    }
+    int streamRows = 0;
+    if(find(args.begin(), args.end(), "-stream") != args.end()
+       && ++find(args.begin(), args.end(), "-stream") != args.end()) {
+        streamRows = stoi(*++find(args.begin(), args.end(), "-stream"));
+        if(streamRows < 1) {
+            err << "Invalid number of rows" << std::endl;
+            return -1;
+        }
+    }
+    int prefetch = 0;
+    if(find(args.begin(), args.end(), "-prefetch") != args.end()
+       && ++find(args.begin(), args.end(), "-prefetch") != args.end()) {
+        prefetch = stoi(*++find(args.begin(), args.end(), "-prefetch"));
+        if(prefetch < 0) {
+            err << "Invalid number of frames" << std::endl;
+            return -1;
+        }
+        if(prefetch > 0 && (streamRows > 0 || sliced)) {
+            err << "-prefetch is not compatible with -stream and -volume"
+                << std::endl;
+            return -1;
+        }
+    }
+    ImageOptions image;
+    if(find(args.begin(), args.end(), "-format") != args.end()
+       && ++find(args.begin(), args.end(), "-format") != args.end()) {
+        image.format = *++find(args.begin(), args.end(), "-format");
+    }
+    if(find(args.begin(), args.end(), "-quality") != args.end()
+       && ++find(args.begin(), args.end(), "-quality") != args.end()) {
+        image.quality = stoi(*++find(args.begin(), args.end(), "-quality"));
+    }
+    if(find(args.begin(), args.end(), "-subsamp") != args.end()
+       && ++find(args.begin(), args.end(), "-subsamp") != args.end()) {
+        const string ss = *++find(args.begin(), args.end(), "-subsamp");
+        if(ss == "444") image.subsampling = TJSAMP_444;
+        else if(ss == "422") image.subsampling = TJSAMP_422;
+        else if(ss == "420") image.subsampling = TJSAMP_420;
+        else if(ss == "gray") image.subsampling = TJSAMP_GRAY;
+        else {
+            err << "Invalid subsampling " << ss << std::endl;
+            return -1;
+        }
+    }
+    image.fastDCT = find(args.begin(), args.end(), "-fastdct") != args.end();
+    if(find(args.begin(), args.end(), "-pnglevel") != args.end()
+       && ++find(args.begin(), args.end(), "-pnglevel") != args.end()) {
+        image.pngLevel = stoi(*++find(args.begin(), args.end(), "-pnglevel"));
+    }
+    if(find(args.begin(), args.end(), "-pngfilter") != args.end()
+       && ++find(args.begin(), args.end(), "-pngfilter") != args.end()) {
+        const string pf = *++find(args.begin(), args.end(), "-pngfilter");
+        if(pf == "none") image.pngFilters = PNG_FILTER_NONE;
+        else if(pf == "sub") image.pngFilters = PNG_FILTER_SUB;
+        else if(pf == "up") image.pngFilters = PNG_FILTER_UP;
+        else if(pf == "avg") image.pngFilters = PNG_FILTER_AVG;
+        else if(pf == "paeth") image.pngFilters = PNG_FILTER_PAETH;
+        else if(pf == "all") image.pngFilters = PNG_ALL_FILTERS;
+        else {
+            err << "Invalid PNG filter " << pf << std::endl;
+            return -1;
+        }
+    }
+    image.lossless = find(args.begin(), args.end(), "-lossless") != args.end();
+    if(find(args.begin(), args.end(), "-je") != args.end()
+       && ++find(args.begin(), args.end(), "-je") != args.end()) {
+        image.encodeThreads = stoi(*++find(args.begin(), args.end(), "-je"));
+        if(image.encodeThreads < 1)
+            image.encodeThreads = max(1, int(thread::hardware_concurrency()));
+    }
+    const bool timing = find(args.begin(), args.end(), "-timing") != args.end();
+    bool rgbOutput = true;
+    try {
+        rgbOutput = AcquireWriter(image, resources)->SupportsRGB();
+    } catch(const std::exception& e) {
+        err << e.what() << std::endl;
+        return -1;
+    }
+    if(streamRows > 0 && image.format != "jpg" && image.format != "jpeg") {
+        err << "-stream supports JPEG output only" << std::endl;
+        return -1;
+    }
+    //indexed output: palette size, 0 = colormap colors
+    int paletteSize = -1;
+    if(find(args.begin(), args.end(), "-palette") != args.end()
+       && ++find(args.begin(), args.end(), "-palette") != args.end()) {
+        const string ps = *++find(args.begin(), args.end(), "-palette");
+        paletteSize = ps == "steps" ? 0 : stoi(ps);
+        if(paletteSize == 1 || paletteSize < 0 || paletteSize > 256) {
+            err << "Invalid palette size " << ps << std::endl;
+            return -1;
+        }
+        if(exact || streamRows > 0) {
+            err << "-palette is not compatible with -exact and -stream"
+                      << std::endl;
+            return -1;
+        }
+        if(!AcquireWriter(image, resources)->SupportsIndexed()) {
+            err << image.format << ": indexed color not supported"
+                      << std::endl;
+            return -1;
+        }
+    }
+    PyramidOptions pyramid;
+    const bool tiled = find(args.begin(), args.end(), "-pyramid") != args.end();
+    if(tiled && ++find(args.begin(), args.end(), "-pyramid") != args.end()) {
+        const string ps = *++find(args.begin(), args.end(), "-pyramid");
+        if(ps == "dzi") pyramid.scheme = PyramidOptions::DEEP_ZOOM;
+        else if(ps == "xyz") pyramid.scheme = PyramidOptions::XYZ;
+        else {
+            err << "Invalid pyramid layout " << ps << std::endl;
+            return -1;
+        }
+    }
+    if(find(args.begin(), args.end(), "-tile") != args.end()
+       && ++find(args.begin(), args.end(), "-tile") != args.end()) {
+        pyramid.tileSize = stoi(*++find(args.begin(), args.end(), "-tile"));
+        if(pyramid.tileSize < 1) {
+            err << "Invalid tile size" << std::endl;
+            return -1;
+        }
+    }
+    if(find(args.begin(), args.end(), "-aggregate") != args.end()
+       && ++find(args.begin(), args.end(), "-aggregate") != args.end()) {
+        const string a = *++find(args.begin(), args.end(), "-aggregate");
+        if(a == "mean") pyramid.aggregate = PyramidOptions::MEAN;
+        else if(a == "max") pyramid.aggregate = PyramidOptions::MAX;
+        else {
+            err << "Invalid aggregate " << a << std::endl;
+            return -1;
+        }
+    }
+    ResampleOptions resample;
+    const bool resize = find(args.begin(), args.end(), "-resize") != args.end();
+    if(resize) {
+        auto i = find(args.begin(), args.end(), "-resize");
+        if(args.end() - i < 3) {
+            err << "Invalid resize" << std::endl;
+            return -1;
+        }
+        resample.width = stoi(*++i);
+        resample.height = stoi(*++i);
+        if(resample.width < 1 || resample.height < 1) {
+            err << "Invalid resize" << std::endl;
+            return -1;
+        }
+        if(tiled || streamRows > 0) {
+            err << "-resize is not compatible with -pyramid and -stream"
+                      << std::endl;
+            return -1;
+        }
+    }
+    if(find(args.begin(), args.end(), "-filter") != args.end()
+       && ++find(args.begin(), args.end(), "-filter") != args.end()) {
+        const string rf = *++find(args.begin(), args.end(), "-filter");
+        if(rf == "box") resample.filter = ResampleOptions::BOX;
+        else if(rf == "bilinear") resample.filter = ResampleOptions::BILINEAR;
+        else if(rf == "max") resample.filter = ResampleOptions::MAX;
+        else {
+            err << "Invalid filter " << rf << std::endl;
+            return -1;
+        }
+    }
+    if(tiled && streamRows > 0) {
+        err << "-pyramid is not compatible with -stream" << std::endl;
+        return -1;
+    }
+    if(paletteSize < 0 && !rgbOutput) {
+        err << image.format << ": RGB images not supported, use -palette"
+                  << std::endl;
+        return -1;
+    }
+    StatisticsOptions statOptions;
+    if(find(args.begin(), args.end(), "-hist") != args.end()
+       && ++find(args.begin(), args.end(), "-hist") != args.end()) {
+        statOptions.bins = stoul(*++find(args.begin(), args.end(), "-hist"));
+    }
+    if(find(args.begin(), args.end(), "-ahist") != args.end()
+       && ++find(args.begin(), args.end(), "-ahist") != args.end()) {
+        statOptions.adaptiveBins =
+            stoul(*++find(args.begin(), args.end(), "-ahist"));
+    }
+    if(find(args.begin(), args.end(), "-pct") != args.end()
+       && ++find(args.begin(), args.end(), "-pct") != args.end()) {
+        istringstream is(*++find(args.begin(), args.end(), "-pct"));
+        string p;
+        while(getline(is, p, ',')) statOptions.percentiles.push_back(stod(p));
+    }
+    size_t lutSize = ColormapLUT::DEFAULT_SIZE;
+    if(find(args.begin(), args.end(), "-lutsize") != args.end()
+       && ++find(args.begin(), args.end(), "-lutsize") != args.end()) {
+        //signed: stoul would wrap negative sizes around
+        const long long n =
+            stoll(*++find(args.begin(), args.end(), "-lutsize"));
+        if(n < 2) {
+            err << "Invalid LUT size" << std::endl;
+            return -1;
+        }
+        lutSize = size_t(n);
+    }
+    int threads = 1;
+    if(find(args.begin(), args.end(), "-j") != args.end()
+       && ++find(args.begin(), args.end(), "-j") != args.end()) {
+        threads = stoi(*++find(args.begin(), args.end(), "-j"));
+        if(threads < 1) threads = max(1, int(thread::hardware_concurrency()));
+    }
+    //threads per frame: by default all the threads go to the single frame,
+    //streaming and pyramid cases, frame level parallelism is used otherwise
+    int frameThreads = startFrame == endFrame || streamRows || tiled ?
+                       threads : 1;
+    if(find(args.begin(), args.end(), "-jf") != args.end()
+       && ++find(args.begin(), args.end(), "-jf") != args.end()) {
+        frameThreads = stoi(*++find(args.begin(), args.end(), "-jf"));
+        if(frameThreads < 1)
+            frameThreads = max(1, int(thread::hardware_concurrency()));
+    }
+    statOptions.threads = frameThreads;
+    statOptions.finite = finite;
+    //colormap, lookup tables and kernel: cached by colormap file,
+    //modification time and options, built once unless in -serve mode
+    string colormapFile;
+    string colormapKey = "default";
+    if(builtinMap) {
+        colormapKey = string("builtin ") + builtinMap->name;
+    } else if(find(args.begin(), args.end(), "-f") != args.end()
        && ++find(args.begin(), args.end(), "-f") != args.end()) {
-        ifstream is(*++find(args.begin(), args.end(), "-f"));
-        if(!is) {
-            std::cerr << "Cannot open input file" << std::endl;
-            return -1;
-        }
-        if(csv) {
-            const KeyData kd = ReadColorsCSV(is, norm);
-            colors = get< KEYFRAME::DATA >(kd);
-            keyframes = get< KEYFRAME::KEYS >(kd);
-        } else colors = ReadColors(is, !hsv);
-    } else { 
-        std::vector< Vector3D< double > > scolors =
-    //{{1,1,1}, {1, 1, 0}, {0, 1, 1}, {1, 0.5, 0.50}, {0, 0.5, 1}, {0.2, 0.4, 1}};
-        {0xFFFFFF, 0xA3F9FF, 0x0FEFFF, 0x0EE1F0, 0x1FD2FF, 0x00C0F0};
-        colors = scolors;
-    }
-    std::vector< double > keys;
-    if(keyframes.size()) keys = keyframes;
+        colormapFile = *++find(args.begin(), args.end(), "-f");
+        struct stat st;
+        if(::stat(colormapFile.c_str(), &st) != 0) {
+            err << "Cannot open input file" << std::endl;
+            return -1;
+        }
+        colormapKey = colormapFile + ' ' + to_string(st.st_mtime) + ' '
+                      + to_string(st.st_size) + ' ' + to_string(csv) + ' '
+                      + to_string(norm) + ' ' + to_string(hsv);
+    }
+    colormapKey += ' ' + to_string(distanceParameterization);
+    const std::shared_ptr< const KeyData > colormap =
+        resources.colormaps.Get(colormapKey, [&]() {
+            if(builtinMap)
+                return KeyData(builtinMap->Colors(), builtinMap->Keys());
+            return ReadColormap(colormapFile, csv, norm, hsv,
+                                distanceParameterization);
+        });
+    const std::vector< Vector3D< double > >& colors =
+        get< KEYFRAME::DATA >(*colormap);
+    const std::vector< double >& keys = get< KEYFRAME::KEYS >(*colormap);
+    const double normFactor = 255.0;
+    //the tables and the kernel depend on hsv for any colormap, including
+    //the default and built-in ones
+    const string mapKey = colormapKey + ' ' + to_string(cubicInterpolation)
+                          + ' ' + to_string(lutEnds) + ' ' + to_string(hsv);
+    std::shared_ptr< const ColormapLUT > lut =
+        std::make_shared< const ColormapLUT >();
+    if(!exact) {
+        lut = resources.luts.Get("lut " + mapKey + ' ' + to_string(lutSize),
+                                 [&]() {
+            return MakeLUT(colors, keys, cubicInterpolation, hsv, normFactor,
+                           lutSize, lutEnds);
+        });
+    }
+    std::shared_ptr< const ColormapLUT > palette;
+    if(paletteSize == 0) {
+        if(colors.size() > 256) {
+            err << "More than 256 colors in colormap" << std::endl;
+            return -1;
+        }
+        palette = resources.luts.Get("steps " + mapKey, [&]() {
+            return StepLUT(colors, hsv, normFactor);
+        });
+    } else if(paletteSize > 0) {
+        palette = resources.luts.Get("palette " + mapKey + ' '
+                                     + to_string(paletteSize), [&]() {
+            return MakeLUT(colors, keys, cubicInterpolation, hsv, normFactor,
+                           size_t(paletteSize), lutEnds);
+        });
+    }
+    //exact evaluation: SIMD batch kernel, HSV maps are converted to RGB in
+    //the same pass
+    const std::shared_ptr< const ColormapKernel > exactKernel =
+        resources.kernels.Get("kernel " + mapKey, [&]() {
+            return ColormapKernel(colors, keys,
+                                  cubicInterpolation ?
+                                  ColormapKernel::CATMULL_ROM
+                                  : ColormapKernel::LINEAR,
+                                  normFactor,
+                                  hsv ? ColormapKernel::HSV
+                                      : ColormapKernel::RGB);
+        });
+    Config cfg{path, prefix, suffix, startFrame, endFrame, width, height,
+               colors, keys, cubicInterpolation, hsv, exact, normFactor,
+               *lut, *exactKernel,
+               exact && builtinMap ? builtinMap->Kernel(cubicInterpolation)
+                                   : nullptr,
+               stat, json, statOptions, finite,
+               threads, frameThreads, swapBytes,
+               volumeFile, sliced ? &volume : nullptr,
+               fixedRange ? &range : nullptr,
+               sequenceRange ? &globalRange : nullptr, streamRows, prefetch,
+               image, timing,
+               palette.get(), tiled ? &pyramid : nullptr,
+               resize ? &resample : nullptr, out, err, resources};
+    if(type == "f64") Render< double >(cfg);
+    else if(type == "f32") Render< float >(cfg);
+    else if(type == "u8") Render< unsigned char >(cfg);
+    else if(type == "u16") Render< unsigned short >(cfg);
+    else if(type == "i16") Render< short >(cfg);
+    else if(type == "i32") Render< int >(cfg);
     else {
-        if(distanceParameterization) {
-            keys = ComputeDistances(colors.begin(), colors.end());
+        err << "Invalid type " << type << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+///Arguments of a job line: separated by white space, double quotes group
+///arguments with spaces
+vector< string > SplitArgs(const string& line) {
+    vector< string > args;
+    string a;
+    bool quoted = false;
+    bool any = false;
+    for(char ch: line) {
+        if(ch == '"') {
+            quoted = !quoted;
+            any = true;
+        } else if(!quoted && (ch == ' ' || ch == '\t' || ch == '\r')) {
+            if(any) args.push_back(a);
+            a.clear();
+            any = false;
         } else {
-            keys.resize(colors.size());
-            for(int k = 0; k != keys.size(); ++k) {
-                keys[k] = double(k) / (keys.size() - 1);
+            a += ch;
+            any = true;
+        }
+    }
+    if(any) args.push_back(a);
+    return args;
+}
+
+///Run the job line @c line, same arguments as the command line without the
+///program name; returns the job output followed by a status line, "OK" or
+///"ERROR <exit status or exception message>"
+string RunJob(const string& program, const string& line,
+              Resources& resources) {
+    vector< string > args = SplitArgs(line);
+    args.insert(args.begin(), program);
+    ostringstream out;
+    string status;
+    try {
+        const int r = Run(args, out, out, resources);
+        status = r == 0 ? "OK" : "ERROR " + to_string(r);
+    } catch(const std::exception& e) {
+        status = string("ERROR ") + e.what();
+    }
+    return out.str() + status + '\n';
+}
+
+///Serve the job lines of a Unix domain socket connection, one at a time
+void ServeConnection(int fd, const string& program, Resources& resources) {
+    string buffer;
+    char chunk[4096];
+    for(;;) {
+        const ssize_t n = read(fd, chunk, sizeof(chunk));
+        if(n <= 0) break;
+        buffer.append(chunk, size_t(n));
+        size_t eol;
+        while((eol = buffer.find('\n')) != string::npos) {
+            const string line = buffer.substr(0, eol);
+            buffer.erase(0, eol + 1);
+            if(SplitArgs(line).empty()) continue;
+            const string reply = RunJob(program, line, resources);
+            for(size_t sent = 0; sent < reply.size();) {
+                const ssize_t w = send(fd, reply.data() + sent,
+                                       reply.size() - sent, MSG_NOSIGNAL);
+                if(w <= 0) {
+                    close(fd);
+                    return;
+                }
+                sent += size_t(w);
             }
         }
     }
-    JPEGWriter w;
-    for(int f = startFrame; f != endFrame + 1; ++f) {
-        Data data = ReadFile(path, prefix, f, suffix);
-        if(stat) {
-            map<double, int> freq;
-            const std::vector< double >& d = get<DATASET>(data);
-            for_each(d.cbegin(), d.cend(), [&freq](double v) {freq[v]++;});
-            using MV = map<double, int>::value_type;
-            map<double, int>::iterator mi = max_element(freq.begin(),
-                                                        freq.end(),
-                                                        [](const MV& v1, const MV& v2){
-                                                            return v1.second < v2.second;
-                                                        });
-            cout << path + prefix + to_string(f) + suffix
-                 << ": min = " << get<DATASET_MIN>(data)
-                 << "  max = " << get<DATASET_MAX>(data)
-                 << "  # levels = " << freq.size()
-                 << "  max levels = " << mi->first << "->" 
-                 << mi->second  
-                 << endl;
-        }
-        const double normFactor = 255.0;
-        std::vector< ColorType > pic;
-        if(!hsv) {
-            pic = cubicInterpolation ?
-            CRKScalarToRGB(get<DATASET>(data), 
-                           colors, 
-                           keys, 
-                           normFactor,
-                           get<DATASET_MIN>(data),
-                           get<DATASET_MAX>(data))
-            : LScalarToRGB(get<DATASET>(data), 
-                           colors, 
-                           keys, 
-                           normFactor,
-                           get<DATASET_MIN>(data),
-                           get<DATASET_MAX>(data));
-                          
-        } else {
-            pic = cubicInterpolation ?
-            CRKScalarHSVToRGB(get<DATASET>(data), 
-                           colors, 
-                           keys, 
-                           normFactor,
-                           get<DATASET_MIN>(data),
-                           get<DATASET_MAX>(data))
-            : LScalarHSVToRGB(get<DATASET>(data), 
-                           colors, 
-                           keys, 
-                           normFactor,
-                           get<DATASET_MIN>(data),
-                           get<DATASET_MAX>(data));    
-        }
-        const string outName = prefix + FrameNumToString(f, endFrame) + ".jpg";
-        w.Save(width, height, outName.c_str(), pic);
+    close(fd);
+}
+
+///Connections served at a time by a -serve daemon, further connections wait
+///in the listen queue
+static const int SERVE_CONNECTIONS = 16;
+
+///Accept and serve connections one at a time until accept fails for good;
+///running out of descriptors or memory is retried after a pause
+void AcceptConnections(int fd, const string& program, Resources& resources) {
+    for(;;) {
+        const int c = accept(fd, nullptr, nullptr);
+        if(c >= 0) {
+            ServeConnection(c, program, resources);
+            continue;
+        }
+        const int e = errno;
+        if(e == EINTR || e == ECONNABORTED) continue;
+        cerr << "Cannot accept connection: " << strerror(e) << endl;
+        if(e != EMFILE && e != ENFILE && e != ENOBUFS && e != ENOMEM) return;
+        this_thread::sleep_for(chrono::milliseconds(100));
     }
-    return 0;
 }
 
+///Daemon mode: run job lines read from stdin or, if @c socketPath is not
+///empty, from the connections to a Unix domain socket, up to
+///SERVE_CONNECTIONS connections served in parallel by a fixed set of
+///threads. Colormaps, lookup tables and image writers are kept across jobs
+int Serve(const string& program, const string& socketPath,
+          Resources& resources) {
+    if(socketPath.empty()) {
+        string line;
+        while(getline(cin, line)) {
+            if(SplitArgs(line).empty()) continue;
+            cout << RunJob(program, line, resources) << flush;
+        }
+        return 0;
+    }
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if(socketPath.size() >= sizeof(addr.sun_path)) {
+        cerr << "Socket path too long" << endl;
+        return -1;
+    }
+    socketPath.copy(addr.sun_path, socketPath.size());
+    //replace the socket of a previous daemon, never any other file
+    struct stat st;
+    if(lstat(socketPath.c_str(), &st) == 0) {
+        if(!S_ISSOCK(st.st_mode)) {
+            cerr << socketPath << " exists and is not a socket" << endl;
+            return -1;
+        }
+        unlink(socketPath.c_str());
+    }
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0
+       || bind(fd, reinterpret_cast< sockaddr* >(&addr), sizeof(addr)) != 0
+       || listen(fd, 64) != 0) {
+        cerr << "Cannot listen on " << socketPath << endl;
+        return -1;
+    }
+    vector< thread > workers;
+    for(int i = 1; i < SERVE_CONNECTIONS; ++i)
+        workers.push_back(thread(AcceptConnections, fd, std::cref(program),
+                                 std::ref(resources)));
+    AcceptConnections(fd, program, resources);
+    for(auto& w: workers) w.join();
+    close(fd);
+    return -1;
+}
+
+//------------------------------------------------------------------------------
+int main(int argc, char** argv) {
+    const vector< string > args(argv, argv + argc);
+    Resources resources;
+    if(argc > 1 && args[1] == "-serve") {
+        return Serve(args[0], argc > 2 ? args[2] : string(), resources);
+    }
+    return Run(args, cout, cerr, resources);
+}
@@ -1,6 +1,6 @@
-// clang++ -std=c++11 -stdlib=libc++ \
+// clang++ -std=c++11 -stdlib=libc++ -pthread \
 // ../src/grayconvert.cpp -I /opt/libjpeg-turbo/include \
-// -L /opt/libjpeg-turbo/lib -lturbojpeg -o grayconvert
+// -L /opt/libjpeg-turbo/lib -lturbojpeg -lz -o grayconvert
 
 #include <string>
 #include <iostream>
@@ -9,14 +9,17 @@
 #include <fstream>
 #include <algorithm>
 #include <sstream>
+#include <thread>
 
 #include "io.h"
+#include "FrameSource.h"
+#include "MinMax.h"
 #include "imageio.h"
 
 using namespace std;
 
 //------------------------------------------------------------------------------
-std::vector< double > ReadFile(string path,
+ScalarFrame< double > ReadFile(string path,
                                string prefix,
                                int n,
                                const string& suffix) {
@@ -24,17 +27,12 @@ std::vector< double > ReadFile(string path,
     if(path[path.size()-1] != '/') path += '/';
     prefix = path + prefix;
     const string fname = prefix + to_string(n) + suffix;
-    ifstream in(fname, std::ifstream::in
-                    | std::ifstream::binary);
-    if(!in) throw std::runtime_error("Cannot read from file");
-    in.seekg(0, ios::end);
-    const size_t fileSize = in.tellg();
-    in.seekg(0, ios::beg);
-    std::vector< double > buf(fileSize / sizeof(double));
-    in.read(reinterpret_cast< char* >(&buf.front()), fileSize);
-    const double MAX = *max_element(buf.begin(), buf.end());
-    const double MIN = *min_element(buf.begin(), buf.end());
-    cout << "min: " << MIN << " max: " << MAX << endl;
+    //compressed (.gz) frames are decompressed by all the cores
+    ScalarFrame< double > buf(fname, false,
+                              max(1, int(thread::hardware_concurrency())));
+    if(buf.empty()) throw std::runtime_error("Empty file");
+    const ScalarRange< double > r = MinMax(buf.begin(), buf.end());
+    cout << "min: " << r.min << " max: " << r.max << endl;
     return buf;
 }
 
@@ -69,9 +67,9 @@ int main(int argc, char** argv) {
     const int height = stoi(argv[7]);
     JPEGWriter w;
     for(int f = startFrame; f != endFrame + 1; ++f) {
-        std::vector< double > data = ReadFile(path, prefix, f, suffix);
-        const std::vector< ColorType > pic = 
-                            ScalarToGray(data, 0.0, 1.0, 255.0);
+        const ScalarFrame< double > data = ReadFile(path, prefix, f, suffix);
+        std::vector< ColorType > pic(3 * data.size());
+        ScalarToGray(data.begin(), data.end(), pic.data(), 0.0, 1.0, 255.0);
         const string outName = "out" + FrameNumToString(f, endFrame) + ".jpg";
         w.Save(width, height, outName.c_str(), pic);
     }
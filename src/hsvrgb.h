@@ -28,7 +28,7 @@ struct hsv {
 
 
 
-hsv rgb2hsv(rgb in) {
+inline hsv rgb2hsv(rgb in) {
     hsv         out;
     double      min, max, delta;
 
@@ -66,7 +66,7 @@ hsv rgb2hsv(rgb in) {
 }
 
 
-rgb hsv2rgb(hsv in) {
+inline rgb hsv2rgb(hsv in) {
     double      hh, p, q, t, ff;
     long        i;
     rgb         out;
@@ -2,29 +2,878 @@
 #include <iostream>
 #include <fstream>
 #include <stdexcept>
+#include <vector>
+#include <cstdio>
+#include <csetjmp>
+#include <cerrno>
+#include <new>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
 #include <turbojpeg.h>
+#include <jpeglib.h>
+#include <zlib.h>
+#include <png.h>
+#ifdef SCOLOR_WITH_WEBP
+#include <webp/encode.h>
+#endif
 
-///JPEG writer @todo add quality parameters as data members
-class JPEGWriter {
+#include "ParallelFor.h"
+
+///Write @c size bytes to file @c fname; plain POSIX I/O, no buffer is
+///allocated
+inline void WriteFile(const char* fname, const unsigned char* data,
+                      std::size_t size) {
+    const int fd = open(fname, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0) throw std::runtime_error("Cannot write to file");
+    while(size > 0) {
+        const ssize_t n = write(fd, data, size);
+        if(n < 0 && errno == EINTR) continue;
+        if(n <= 0) {
+            close(fd);
+            throw std::runtime_error("Cannot write to file");
+        }
+        data += n;
+        size -= std::size_t(n);
+    }
+    if(close(fd) != 0) throw std::runtime_error("Cannot write to file");
+}
+
+//------------------------------------------------------------------------------
+///Cumulative encoding statistics of an ImageWriter
+struct EncodeStats {
+    std::size_t images = 0;
+    std::size_t pixels = 0;
+    ///encoded size
+    std::size_t bytes = 0;
+    ///time spent encoding, file output excluded
+    double seconds = 0.0;
+    void Merge(const EncodeStats& s) {
+        images += s.images;
+        pixels += s.pixels;
+        bytes += s.bytes;
+        seconds += s.seconds;
+    }
+};
+
+///Image encoder interface: images are RGB8, stored bottom-up i.e. the first
+///row in memory is the bottom row of the image. Each backend times its own
+///encoding.
+class ImageWriter {
+public:
+    virtual ~ImageWriter() {}
+    virtual void Save(int width, int height, const char* fname,
+                      const unsigned char* data) = 0;
+    void Save(int width, int height, const char* fname,
+              const std::vector< unsigned char >& data) {
+        Save(width, height, fname, data.data());
+    }
+    ///Save an image of 8 bit indices into @c palette, which holds
+    ///@c paletteSize <= 256 RGB colors; indices are stored bottom-up as well
+    virtual void SaveIndexed(int /*width*/, int /*height*/,
+                             const char* /*fname*/,
+                             const unsigned char* /*indices*/,
+                             const unsigned char* /*palette*/,
+                             int /*paletteSize*/) {
+        throw std::runtime_error(std::string(Extension())
+                                 + ": indexed color not supported");
+    }
+    virtual bool SupportsIndexed() const { return false; }
+    virtual bool SupportsRGB() const { return true; }
+    ///File name extension, without the dot
+    virtual const char* Extension() const = 0;
+    const EncodeStats& Stats() const { return stats_; }
+    void ResetStats() { stats_ = EncodeStats(); }
+protected:
+    ///Call encode() which returns the encoded size and account for it
+    template < typename F >
+    void Timed(int width, int height, F encode) {
+        const auto start = std::chrono::steady_clock::now();
+        const std::size_t size = encode();
+        stats_.seconds += std::chrono::duration< double >(
+                              std::chrono::steady_clock::now() - start).count();
+        ++stats_.images;
+        stats_.pixels += std::size_t(width) * std::size_t(height);
+        stats_.bytes += size;
+    }
+private:
+    EncodeStats stats_;
+};
+
+//------------------------------------------------------------------------------
+///JPEG writer, default is quality 100 with 4:4:4 sampling.
+///The compressed image buffer is allocated once for the largest image size
+///seen and reused by all the following frames.
+class JPEGWriter : public ImageWriter {
 public:
-    JPEGWriter() {
+    using ImageWriter::Save;
+    ///@c subsampling is one of the TJSAMP_* values, @c fastDCT selects the
+    ///faster, less accurate DCT
+    explicit JPEGWriter(int quality = 100, int subsampling = TJSAMP_444,
+                        bool fastDCT = false)
+        : quality_(quality), subsampling_(subsampling),
+          flags_(TJXOP_VFLIP | TJFLAG_NOREALLOC
+                 | (fastDCT ? TJFLAG_FASTDCT : 0)) {
         tj_ = tjInitCompress();
+        if(!tj_) throw std::runtime_error(tjGetErrorStr());
     }
-    void Save(int width, int height, const char* fname, 
-              const std::vector< unsigned char >& data) const {
-        unsigned char* out = nullptr;
-        unsigned long size = 0;
-        tjCompress2(tj_, const_cast< unsigned char* >(&data[0]),
-                    width, tjPixelSize[TJPF_RGB] * width, height,
-                    TJPF_RGB, &out,
-                    &size, TJSAMP_444, 100, TJXOP_VFLIP);
-        std::ofstream os(fname, std::ios::out | std::ios::binary);
-        if(!os) throw std::runtime_error("Cannot write to file");
-        os.write(reinterpret_cast< char* >(out), size);
+    JPEGWriter(const JPEGWriter&) = delete;
+    JPEGWriter& operator=(const JPEGWriter&) = delete;
+    void Save(int width, int height, const char* fname,
+              const unsigned char* data) override {
+        const unsigned long capacity = tjBufSize(width, height, subsampling_);
+        if(capacity > capacity_) {
+            tjFree(buffer_);
+            buffer_ = tjAlloc(int(capacity));
+            capacity_ = buffer_ ? capacity : 0;
+            if(!buffer_) throw std::bad_alloc();
+        }
+        unsigned long size = capacity_;
+        Timed(width, height, [&]() {
+            if(tjCompress2(tj_, const_cast< unsigned char* >(data),
+                           width, tjPixelSize[TJPF_RGB] * width, height,
+                           TJPF_RGB, &buffer_,
+                           &size, subsampling_, quality_, flags_) != 0) {
+                throw std::runtime_error(tjGetErrorStr());
+            }
+            return std::size_t(size);
+        });
+        WriteFile(fname, buffer_, size);
     }
+    const char* Extension() const override { return "jpg"; }
     ~JPEGWriter() {
+        tjFree(buffer_);
         tjDestroy(tj_);
     }
 private:
+    int quality_;
+    int subsampling_;
+    int flags_;
     tjhandle tj_;
+    unsigned char* buffer_ = nullptr;
+    unsigned long capacity_ = 0;
+};
+
+//------------------------------------------------------------------------------
+///PNG writer, the image is encoded into a memory buffer reused across
+///frames then written at once.
+class PNGWriter : public ImageWriter {
+public:
+    using ImageWriter::Save;
+    ///@c level is the zlib compression level, 0 to 9; @c filters is a
+    ///combination of the PNG_FILTER_* flags
+    explicit PNGWriter(int level = Z_DEFAULT_COMPRESSION,
+                       int filters = PNG_ALL_FILTERS)
+        : level_(level), filters_(filters) {}
+    void Save(int width, int height, const char* fname,
+              const unsigned char* data) override {
+        Encode(width, height, fname, data, 3, nullptr, 0);
+    }
+    ///8 bit paletted PNG
+    void SaveIndexed(int width, int height, const char* fname,
+                     const unsigned char* indices,
+                     const unsigned char* palette, int paletteSize) override {
+        Encode(width, height, fname, indices, 1, palette, paletteSize);
+    }
+    bool SupportsIndexed() const override { return true; }
+    const char* Extension() const override { return "png"; }
+private:
+    ///RGB image if @c palette is null, indexed image otherwise
+    void Encode(int width, int height, const char* fname,
+                const unsigned char* data, int pixelSize,
+                const unsigned char* palette, int paletteSize) {
+        rows_.resize(height);
+        const std::size_t pitch = std::size_t(pixelSize) * width;
+        for(int r = 0; r != height; ++r)
+            rows_[r] = const_cast< png_bytep >(data + (height - 1 - r) * pitch);
+        png_color colors[256];
+        for(int i = 0; palette && i != paletteSize; ++i) {
+            colors[i].red = palette[3 * i];
+            colors[i].green = palette[3 * i + 1];
+            colors[i].blue = palette[3 * i + 2];
+        }
+        Timed(width, height, [&]() {
+            buffer_.clear();
+            png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING,
+                                                      nullptr, nullptr,
+                                                      nullptr);
+            if(!png) throw std::bad_alloc();
+            png_infop info = png_create_info_struct(png);
+            if(!info || setjmp(png_jmpbuf(png))) {
+                png_destroy_write_struct(&png, &info);
+                throw std::runtime_error("PNG compression error");
+            }
+            png_set_write_fn(png, &buffer_, Append, nullptr);
+            png_set_compression_level(png, level_);
+            png_set_filter(png, PNG_FILTER_TYPE_BASE, filters_);
+            png_set_IHDR(png, info, width, height, 8,
+                         palette ? PNG_COLOR_TYPE_PALETTE : PNG_COLOR_TYPE_RGB,
+                         PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE,
+                         PNG_FILTER_TYPE_BASE);
+            if(palette) png_set_PLTE(png, info, colors, paletteSize);
+            png_write_info(png, info);
+            png_write_image(png, rows_.data());
+            png_write_end(png, nullptr);
+            png_destroy_write_struct(&png, &info);
+            return buffer_.size();
+        });
+        WriteFile(fname, buffer_.data(), buffer_.size());
+    }
+    static void Append(png_structp png, png_bytep data, png_size_t size) {
+        std::vector< unsigned char >* b =
+            static_cast< std::vector< unsigned char >* >(png_get_io_ptr(png));
+        b->insert(b->end(), data, data + size);
+    }
+private:
+    int level_;
+    int filters_;
+    std::vector< png_bytep > rows_;
+    std::vector< unsigned char > buffer_;
+};
+
+//------------------------------------------------------------------------------
+#ifdef SCOLOR_WITH_WEBP
+///WebP writer, lossy with quality in [0, 100] or lossless
+class WebPWriter : public ImageWriter {
+public:
+    using ImageWriter::Save;
+    explicit WebPWriter(float quality = 100.0f, bool lossless = false)
+        : quality_(quality), lossless_(lossless) {}
+    void Save(int width, int height, const char* fname,
+              const unsigned char* data) override {
+        //bottom-up: start from the last row with a negative stride
+        const int stride = -3 * width;
+        const unsigned char* top = data + std::size_t(height - 1) * 3 * width;
+        uint8_t* out = nullptr;
+        std::size_t size = 0;
+        Timed(width, height, [&]() {
+            size = lossless_ ?
+                   WebPEncodeLosslessRGB(top, width, height, stride, &out)
+                 : WebPEncodeRGB(top, width, height, stride, quality_, &out);
+            if(!size) throw std::runtime_error("WebP compression error");
+            return size;
+        });
+        try {
+            WriteFile(fname, out, size);
+        } catch(...) {
+            WebPFree(out);
+            throw;
+        }
+        WebPFree(out);
+    }
+    const char* Extension() const override { return "webp"; }
+private:
+    float quality_;
+    bool lossless_;
+};
+#endif
+
+//------------------------------------------------------------------------------
+///Uncompressed output, binary PPM (P6) or headerless RGB rows, top to
+///bottom; no encoding besides the row order
+class PPMWriter : public ImageWriter {
+public:
+    using ImageWriter::Save;
+    explicit PPMWriter(bool header = true) : header_(header) {}
+    void Save(int width, int height, const char* fname,
+              const unsigned char* data) override {
+        Timed(width, height, [&]() {
+            char h[64] = {0};
+            const int hsize = header_ ?
+                std::snprintf(h, sizeof(h), "P6\n%d %d\n255\n", width, height)
+                : 0;
+            const std::size_t pitch = 3 * std::size_t(width);
+            buffer_.resize(hsize + pitch * height);
+            std::copy(h, h + hsize, buffer_.begin());
+            for(int r = 0; r != height; ++r) {
+                std::copy(data + (height - 1 - r) * pitch,
+                          data + (height - r) * pitch,
+                          buffer_.begin() + hsize + r * pitch);
+            }
+            return buffer_.size();
+        });
+        WriteFile(fname, buffer_.data(), buffer_.size());
+    }
+    const char* Extension() const override { return header_ ? "ppm" : "rgb"; }
+private:
+    bool header_;
+    std::vector< unsigned char > buffer_;
+};
+
+//------------------------------------------------------------------------------
+namespace detail {
+///GIF variable length LZW encoder, codes are packed LSB first into 255 byte
+///sub-blocks
+class GIFLZWEncoder {
+public:
+    GIFLZWEncoder() : keys_(HASH_SIZE), codes_(HASH_SIZE) {}
+    ///Append the sub-blocks encoding the indices in @c rows to @c out;
+    ///@c minCodeSize is the number of bits per index, at least 2
+    template < typename RowF >
+    void Encode(int width, int height, RowF rows, int minCodeSize,
+                std::vector< unsigned char >& out) {
+        out_ = &out;
+        bits_ = 0;
+        nbits_ = 0;
+        block_.clear();
+        const int clear = 1 << minCodeSize;
+        const int eoi = clear + 1;
+        Reset(minCodeSize);
+        Put(clear);
+        int prefix = -1;
+        for(int r = 0; r != height; ++r) {
+            const unsigned char* row = rows(r);
+            for(int x = 0; x != width; ++x) {
+                const int k = row[x];
+                if(prefix < 0) {
+                    prefix = k;
+                    continue;
+                }
+                const int key = (prefix << 8) | k;
+                int h = Hash(key);
+                while(keys_[h] >= 0 && keys_[h] != key) h = (h + 1) & HASH_MASK;
+                if(keys_[h] == key) {
+                    prefix = codes_[h];
+                    continue;
+                }
+                Put(prefix);
+                keys_[h] = key;
+                codes_[h] = (unsigned short)(++maxCode_);
+                if(maxCode_ >= (1 << codeSize_)) ++codeSize_;
+                if(maxCode_ == MAX_CODE) {
+                    Put(clear);
+                    Reset(minCodeSize);
+                }
+                prefix = k;
+            }
+        }
+        if(prefix >= 0) Put(prefix);
+        Put(eoi);
+        if(nbits_ > 0) Byte((unsigned char)(bits_));
+        Flush();
+        out.push_back(0);
+    }
+private:
+    enum {MAX_CODE = 4095, HASH_SIZE = 1 << 13, HASH_MASK = HASH_SIZE - 1};
+    static int Hash(int key) {
+        return int((unsigned(key) * 2654435761u) >> 19) & HASH_MASK;
+    }
+    void Reset(int minCodeSize) {
+        std::fill(keys_.begin(), keys_.end(), -1);
+        codeSize_ = minCodeSize + 1;
+        maxCode_ = (1 << minCodeSize) + 1;
+    }
+    void Put(int code) {
+        bits_ |= unsigned(code) << nbits_;
+        nbits_ += codeSize_;
+        while(nbits_ >= 8) {
+            Byte((unsigned char)(bits_));
+            bits_ >>= 8;
+            nbits_ -= 8;
+        }
+    }
+    void Byte(unsigned char b) {
+        block_.push_back(b);
+        if(block_.size() == 255) Flush();
+    }
+    void Flush() {
+        if(block_.empty()) return;
+        out_->push_back((unsigned char)(block_.size()));
+        out_->insert(out_->end(), block_.begin(), block_.end());
+        block_.clear();
+    }
+private:
+    std::vector< int > keys_;
+    std::vector< unsigned short > codes_;
+    std::vector< unsigned char > block_;
+    std::vector< unsigned char >* out_ = nullptr;
+    unsigned bits_ = 0;
+    int nbits_ = 0;
+    int codeSize_ = 0;
+    int maxCode_ = 0;
+};
+
+inline void PutLE16(std::vector< unsigned char >& b, unsigned v) {
+    b.push_back((unsigned char)(v & 0xFF));
+    b.push_back((unsigned char)(v >> 8));
+}
+
+inline void PutLE32(std::vector< unsigned char >& b, unsigned v) {
+    PutLE16(b, v & 0xFFFF);
+    PutLE16(b, v >> 16);
+}
+} //namespace detail
+
+///GIF writer, indexed images only
+class GIFWriter : public ImageWriter {
+public:
+    using ImageWriter::Save;
+    void Save(int, int, const char*, const unsigned char*) override {
+        throw std::runtime_error("gif: RGB images not supported, "
+                                 "use a palette");
+    }
+    void SaveIndexed(int width, int height, const char* fname,
+                     const unsigned char* indices,
+                     const unsigned char* palette, int paletteSize) override {
+        if(width > 0xFFFF || height > 0xFFFF)
+            throw std::runtime_error("gif: image too large");
+        Timed(width, height, [&]() {
+            int bits = 1;
+            while((1 << bits) < paletteSize) ++bits;
+            const char header[] = "GIF89a";
+            buffer_.assign(header, header + 6);
+            detail::PutLE16(buffer_, unsigned(width));
+            detail::PutLE16(buffer_, unsigned(height));
+            //global color table of 2^bits entries
+            buffer_.push_back((unsigned char)(0x80 | ((bits - 1) << 4)
+                                              | (bits - 1)));
+            buffer_.push_back(0);
+            buffer_.push_back(0);
+            buffer_.insert(buffer_.end(), palette, palette + 3 * paletteSize);
+            buffer_.insert(buffer_.end(), 3 * ((1 << bits) - paletteSize), 0);
+            //image descriptor
+            buffer_.push_back(0x2C);
+            detail::PutLE16(buffer_, 0);
+            detail::PutLE16(buffer_, 0);
+            detail::PutLE16(buffer_, unsigned(width));
+            detail::PutLE16(buffer_, unsigned(height));
+            buffer_.push_back(0);
+            const int minCodeSize = std::max(2, bits);
+            buffer_.push_back((unsigned char)(minCodeSize));
+            //bottom-up rows
+            lzw_.Encode(width, height, [&](int r) {
+                return indices + std::size_t(height - 1 - r) * width;
+            }, minCodeSize, buffer_);
+            buffer_.push_back(0x3B);
+            return buffer_.size();
+        });
+        WriteFile(fname, buffer_.data(), buffer_.size());
+    }
+    bool SupportsIndexed() const override { return true; }
+    bool SupportsRGB() const override { return false; }
+    const char* Extension() const override { return "gif"; }
+private:
+    detail::GIFLZWEncoder lzw_;
+    std::vector< unsigned char > buffer_;
+};
+
+//------------------------------------------------------------------------------
+///Uncompressed BMP writer, 24 bit RGB or 8 bit indexed; BMP rows are stored
+///bottom-up as the images
+class BMPWriter : public ImageWriter {
+public:
+    using ImageWriter::Save;
+    void Save(int width, int height, const char* fname,
+              const unsigned char* data) override {
+        Encode(width, height, fname, data, 3, nullptr, 0);
+    }
+    void SaveIndexed(int width, int height, const char* fname,
+                     const unsigned char* indices,
+                     const unsigned char* palette, int paletteSize) override {
+        Encode(width, height, fname, indices, 1, palette, paletteSize);
+    }
+    bool SupportsIndexed() const override { return true; }
+    const char* Extension() const override { return "bmp"; }
+private:
+    void Encode(int width, int height, const char* fname,
+                const unsigned char* data, int pixelSize,
+                const unsigned char* palette, int paletteSize) {
+        Timed(width, height, [&]() {
+            const std::size_t pitch = std::size_t(pixelSize) * width;
+            const std::size_t paddedPitch = (pitch + 3) / 4 * 4;
+            const unsigned paletteBytes = 4 * unsigned(paletteSize);
+            const unsigned offset = 14 + 40 + paletteBytes;
+            buffer_.clear();
+            buffer_.push_back('B');
+            buffer_.push_back('M');
+            detail::PutLE32(buffer_, unsigned(offset + paddedPitch * height));
+            detail::PutLE32(buffer_, 0);
+            detail::PutLE32(buffer_, offset);
+            //BITMAPINFOHEADER
+            detail::PutLE32(buffer_, 40);
+            detail::PutLE32(buffer_, unsigned(width));
+            detail::PutLE32(buffer_, unsigned(height));
+            detail::PutLE16(buffer_, 1);
+            detail::PutLE16(buffer_, unsigned(8 * pixelSize));
+            detail::PutLE32(buffer_, 0);
+            detail::PutLE32(buffer_, unsigned(paddedPitch * height));
+            detail::PutLE32(buffer_, 2835);
+            detail::PutLE32(buffer_, 2835);
+            detail::PutLE32(buffer_, unsigned(paletteSize));
+            detail::PutLE32(buffer_, 0);
+            for(int i = 0; i != paletteSize; ++i) {
+                buffer_.push_back(palette[3 * i + 2]);
+                buffer_.push_back(palette[3 * i + 1]);
+                buffer_.push_back(palette[3 * i]);
+                buffer_.push_back(0);
+            }
+            std::size_t p = buffer_.size();
+            buffer_.resize(p + paddedPitch * height, 0);
+            for(int r = 0; r != height; ++r, p += paddedPitch) {
+                const unsigned char* row = data + r * pitch;
+                if(pixelSize == 1) {
+                    std::copy(row, row + pitch, buffer_.begin() + p);
+                } else for(int x = 0; x != width; ++x) {
+                    //BGR
+                    buffer_[p + 3 * x]     = row[3 * x + 2];
+                    buffer_[p + 3 * x + 1] = row[3 * x + 1];
+                    buffer_[p + 3 * x + 2] = row[3 * x];
+                }
+            }
+            return buffer_.size();
+        });
+        WriteFile(fname, buffer_.data(), buffer_.size());
+    }
+private:
+    std::vector< unsigned char > buffer_;
 };
+
+//------------------------------------------------------------------------------
+namespace detail {
+///libjpeg error manager: errors longjmp back to the caller, which throws
+struct JPEGErrorManager {
+    jpeg_error_mgr mgr;
+    std::jmp_buf jmp;
+};
+
+inline void JPEGErrorExit(j_common_ptr cinfo) {
+    std::longjmp(reinterpret_cast< JPEGErrorManager* >(cinfo->err)->jmp, 1);
+}
+
+///Luma sampling factors of a TJSAMP_* value, chroma is sampled once per MCU
+inline void JPEGSamplingFactors(int subsampling, int& h, int& v) {
+    h = 1;
+    v = 1;
+    switch(subsampling) {
+    case TJSAMP_GRAY:
+    case TJSAMP_444:
+        break;
+    case TJSAMP_422:
+        h = 2;
+        break;
+    case TJSAMP_420:
+        h = 2;
+        v = 2;
+        break;
+    default:
+        throw std::logic_error("Unsupported JPEG subsampling");
+    }
+}
+
+///Height in rows of the MCUs of a TJSAMP_* value
+inline int JPEGMCURows(int subsampling) {
+    int h;
+    int v;
+    JPEGSamplingFactors(subsampling, h, v);
+    return 8 * v;
+}
+
+///Set the libjpeg sampling factors matching a TJSAMP_* value, call after
+///jpeg_set_defaults
+inline void SetJPEGSubsampling(jpeg_compress_struct& cinfo, int subsampling) {
+    int h;
+    int v;
+    JPEGSamplingFactors(subsampling, h, v);
+    if(subsampling == TJSAMP_GRAY) jpeg_set_colorspace(&cinfo, JCS_GRAYSCALE);
+    cinfo.comp_info[0].h_samp_factor = h;
+    cinfo.comp_info[0].v_samp_factor = v;
+    for(int c = 1; c < cinfo.num_components; ++c) {
+        cinfo.comp_info[c].h_samp_factor = 1;
+        cinfo.comp_info[c].v_samp_factor = 1;
+    }
+}
+} //namespace detail
+
+///Strip based JPEG writer: the image is compressed a strip of rows at a time
+///through the libjpeg scanline API while it is being produced, neither the
+///whole RGB image nor the whole compressed image is ever held in memory.
+///Same default encoding parameters as JPEGWriter: quality 100, 4:4:4.
+class JPEGStripWriter {
+public:
+    JPEGStripWriter(const char* fname, int width, int height,
+                    int quality = 100, int subsampling = TJSAMP_444)
+        : width_(width) {
+        file_ = std::fopen(fname, "wb");
+        if(!file_) throw std::runtime_error("Cannot write to file");
+        cinfo_.err = jpeg_std_error(&err_.mgr);
+        err_.mgr.error_exit = detail::JPEGErrorExit;
+        if(setjmp(err_.jmp)) {
+            Close();
+            throw std::runtime_error("JPEG compression error");
+        }
+        jpeg_create_compress(&cinfo_);
+        jpeg_stdio_dest(&cinfo_, file_);
+        cinfo_.image_width = width;
+        cinfo_.image_height = height;
+        cinfo_.input_components = 3;
+        cinfo_.in_color_space = JCS_RGB;
+        jpeg_set_defaults(&cinfo_);
+        jpeg_set_quality(&cinfo_, quality, TRUE);
+        detail::SetJPEGSubsampling(cinfo_, subsampling);
+        jpeg_start_compress(&cinfo_, TRUE);
+    }
+    JPEGStripWriter(const JPEGStripWriter&) = delete;
+    JPEGStripWriter& operator=(const JPEGStripWriter&) = delete;
+    ///Append @c numRows RGB rows to the image, top to bottom; with
+    ///@c bottomUp the rows are stored bottom to top in @c rows
+    void WriteRows(const unsigned char* rows, int numRows,
+                   bool bottomUp = false) {
+        rowPointers_.resize(numRows);
+        const std::size_t pitch = 3 * std::size_t(width_);
+        for(int r = 0; r != numRows; ++r) {
+            const int i = bottomUp ? numRows - 1 - r : r;
+            rowPointers_[r] = const_cast< JSAMPROW >(rows + i * pitch);
+        }
+        if(setjmp(err_.jmp)) {
+            Close();
+            throw std::runtime_error("JPEG compression error");
+        }
+        jpeg_write_scanlines(&cinfo_, rowPointers_.data(), numRows);
+    }
+    ///Complete the image, all the rows must have been written
+    void Finish() {
+        if(!file_) return;
+        if(setjmp(err_.jmp)) {
+            Close();
+            throw std::runtime_error("JPEG compression error");
+        }
+        jpeg_finish_compress(&cinfo_);
+        Close();
+    }
+    ~JPEGStripWriter() { Close(); }
+private:
+    void Close() {
+        if(!file_) return;
+        jpeg_destroy_compress(&cinfo_);
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+private:
+    int width_;
+    std::FILE* file_ = nullptr;
+    jpeg_compress_struct cinfo_;
+    detail::JPEGErrorManager err_;
+    std::vector< JSAMPROW > rowPointers_;
+};
+
+//------------------------------------------------------------------------------
+///JPEG writer encoding each image on multiple threads: the image is split
+///into horizontal strips of whole MCU rows encoded concurrently with a
+///restart marker at the start of each MCU row, then the strips are stitched
+///into a single baseline JPEG: headers of the first strip with the full
+///image height, entropy coded data of all the strips with the restart
+///markers renumbered. Restart markers reset the DC prediction, so the result
+///decodes as a single image encoded with one restart interval per MCU row.
+///Standard (non optimized) Huffman tables are used, shared by all strips.
+class ParallelJPEGWriter : public ImageWriter {
+public:
+    using ImageWriter::Save;
+    ParallelJPEGWriter(int threads, int quality = 100,
+                       int subsampling = TJSAMP_444, bool fastDCT = false)
+        : threads_(std::max(1, threads)), quality_(quality),
+          subsampling_(subsampling), fastDCT_(fastDCT) {}
+    void Save(int width, int height, const char* fname,
+              const unsigned char* data) override {
+        const int mcuRows = detail::JPEGMCURows(subsampling_);
+        //about two strips per thread for load balancing
+        const int strips = std::max(1, std::min(2 * threads_,
+                                                height / (4 * mcuRows)));
+        int stripRows = (height + strips - 1) / strips;
+        stripRows = (stripRows + mcuRows - 1) / mcuRows * mcuRows;
+        const int n = (height + stripRows - 1) / stripRows;
+        if(int(strips_.size()) < n) strips_.resize(n);
+        Timed(width, height, [&]() {
+            ParallelFor(std::size_t(n), 1, threads_,
+                        [&](std::size_t b, std::size_t e) {
+                for(std::size_t i = b; i != e; ++i) {
+                    const int top = int(i) * stripRows;
+                    EncodeStrip(width, height, top,
+                                std::min(stripRows, height - top), data,
+                                strips_[i]);
+                }
+            });
+            Stitch(height, n);
+            return buffer_.size();
+        });
+        WriteFile(fname, buffer_.data(), buffer_.size());
+    }
+    const char* Extension() const override { return "jpg"; }
+private:
+    ///libjpeg destination writing to a vector
+    struct Destination {
+        jpeg_destination_mgr mgr;
+        std::vector< unsigned char >* buffer;
+    };
+    static void InitDestination(j_compress_ptr cinfo) {
+        Destination* d = reinterpret_cast< Destination* >(cinfo->dest);
+        d->buffer->resize(std::max(std::size_t(1 << 16),
+                                   d->buffer->capacity()));
+        d->mgr.next_output_byte = d->buffer->data();
+        d->mgr.free_in_buffer = d->buffer->size();
+    }
+    static boolean EmptyOutputBuffer(j_compress_ptr cinfo) {
+        Destination* d = reinterpret_cast< Destination* >(cinfo->dest);
+        const std::size_t used = d->buffer->size();
+        d->buffer->resize(2 * used);
+        d->mgr.next_output_byte = d->buffer->data() + used;
+        d->mgr.free_in_buffer = d->buffer->size() - used;
+        return TRUE;
+    }
+    static void TermDestination(j_compress_ptr cinfo) {
+        Destination* d = reinterpret_cast< Destination* >(cinfo->dest);
+        d->buffer->resize(d->buffer->size() - d->mgr.free_in_buffer);
+    }
+    ///Encode image rows [top, top + rows) as a standalone JPEG
+    void EncodeStrip(int width, int height, int top, int rows,
+                     const unsigned char* data,
+                     std::vector< unsigned char >& out) const {
+        jpeg_compress_struct cinfo;
+        detail::JPEGErrorManager err;
+        cinfo.err = jpeg_std_error(&err.mgr);
+        err.mgr.error_exit = detail::JPEGErrorExit;
+        if(setjmp(err.jmp)) {
+            jpeg_destroy_compress(&cinfo);
+            throw std::runtime_error("JPEG compression error");
+        }
+        jpeg_create_compress(&cinfo);
+        Destination dest;
+        dest.mgr.init_destination = InitDestination;
+        dest.mgr.empty_output_buffer = EmptyOutputBuffer;
+        dest.mgr.term_destination = TermDestination;
+        dest.buffer = &out;
+        cinfo.dest = &dest.mgr;
+        cinfo.image_width = width;
+        cinfo.image_height = rows;
+        cinfo.input_components = 3;
+        cinfo.in_color_space = JCS_RGB;
+        jpeg_set_defaults(&cinfo);
+        jpeg_set_quality(&cinfo, quality_, TRUE);
+        detail::SetJPEGSubsampling(cinfo, subsampling_);
+        cinfo.optimize_coding = FALSE;
+        cinfo.restart_in_rows = 1;
+        if(fastDCT_) cinfo.dct_method = JDCT_IFAST;
+        jpeg_start_compress(&cinfo, TRUE);
+        const std::size_t pitch = 3 * std::size_t(width);
+        while(int(cinfo.next_scanline) < rows) {
+            //bottom-up image: image row r is data row height - 1 - r
+            JSAMPROW row = const_cast< JSAMPROW >(
+                data + std::size_t(height - 1 - top - int(cinfo.next_scanline))
+                       * pitch);
+            jpeg_write_scanlines(&cinfo, &row, 1);
+        }
+        jpeg_finish_compress(&cinfo);
+        jpeg_destroy_compress(&cinfo);
+    }
+    static unsigned BE16(const unsigned char* p) {
+        return (unsigned(p[0]) << 8) | p[1];
+    }
+    ///Offset of the first byte after the SOS header, also patches the image
+    ///height in the SOF header if @c height >= 0
+    static std::size_t ScanStart(std::vector< unsigned char >& j, int height) {
+        std::size_t i = 2;
+        while(i + 4 <= j.size() && j[i] == 0xFF) {
+            const unsigned char m = j[i + 1];
+            const std::size_t length = BE16(&j[i + 2]);
+            if(m >= 0xC0 && m <= 0xC2 && height >= 0) {
+                j[i + 5] = (unsigned char)(height >> 8);
+                j[i + 6] = (unsigned char)(height & 0xFF);
+            }
+            if(m == 0xDA) return i + 2 + length;
+            i += 2 + length;
+        }
+        throw std::runtime_error("Invalid JPEG strip");
+    }
+    void Stitch(int height, int n) {
+        buffer_.clear();
+        const std::size_t header = ScanStart(strips_[0], height);
+        buffer_.insert(buffer_.end(), strips_[0].begin(),
+                       strips_[0].begin() + header);
+        unsigned rst = 0;
+        for(int s = 0; s != n; ++s) {
+            std::vector< unsigned char >& j = strips_[s];
+            if(s > 0) {
+                buffer_.push_back(0xFF);
+                buffer_.push_back((unsigned char)(0xD0 + (rst++ & 7)));
+            }
+            //entropy coded data up to EOI, 0xFF is followed by a stuffed 0
+            //or by a restart marker
+            const std::size_t end = j.size() - 2;
+            for(std::size_t i = s ? ScanStart(j, -1) : header; i < end; ++i) {
+                buffer_.push_back(j[i]);
+                if(j[i] == 0xFF && i + 1 < end
+                   && j[i + 1] >= 0xD0 && j[i + 1] <= 0xD7) {
+                    buffer_.push_back((unsigned char)(0xD0 + (rst++ & 7)));
+                    ++i;
+                }
+            }
+        }
+        buffer_.push_back(0xFF);
+        buffer_.push_back(0xD9);
+    }
+private:
+    int threads_;
+    int quality_;
+    int subsampling_;
+    bool fastDCT_;
+    std::vector< std::vector< unsigned char > > strips_;
+    std::vector< unsigned char > buffer_;
+};
+
+//------------------------------------------------------------------------------
+///Output format and encoder parameters, used by MakeImageWriter
+struct ImageOptions {
+    ///jpg, png, webp, gif, bmp, ppm or raw
+    std::string format = "jpg";
+    ///JPEG and lossy WebP quality
+    int quality = 100;
+    ///TJSAMP_* JPEG chroma subsampling
+    int subsampling = TJSAMP_444;
+    bool fastDCT = false;
+    ///zlib level and PNG_FILTER_* flags
+    int pngLevel = Z_DEFAULT_COMPRESSION;
+    int pngFilters = PNG_ALL_FILTERS;
+    ///lossless WebP
+    bool lossless = false;
+    ///threads encoding each JPEG image, see ParallelJPEGWriter
+    int encodeThreads = 1;
+    ///Same key, same writer configuration
+    std::string Key() const {
+        return format + ' ' + std::to_string(quality) + ' '
+               + std::to_string(subsampling) + ' ' + std::to_string(fastDCT)
+               + ' ' + std::to_string(pngLevel) + ' '
+               + std::to_string(pngFilters) + ' ' + std::to_string(lossless)
+               + ' ' + std::to_string(encodeThreads);
+    }
+};
+
+inline std::unique_ptr< ImageWriter > MakeImageWriter(const ImageOptions& o) {
+    if((o.format == "jpg" || o.format == "jpeg") && o.encodeThreads > 1) {
+        return std::unique_ptr< ImageWriter >(
+                   new ParallelJPEGWriter(o.encodeThreads, o.quality,
+                                          o.subsampling, o.fastDCT));
+    } else if(o.format == "jpg" || o.format == "jpeg") {
+        return std::unique_ptr< ImageWriter >(
+                   new JPEGWriter(o.quality, o.subsampling, o.fastDCT));
+    } else if(o.format == "png") {
+        return std::unique_ptr< ImageWriter >(
+                   new PNGWriter(o.pngLevel, o.pngFilters));
+    } else if(o.format == "webp") {
+#ifdef SCOLOR_WITH_WEBP
+        return std::unique_ptr< ImageWriter >(
+                   new WebPWriter(float(o.quality), o.lossless));
+#else
+        throw std::runtime_error("WebP support not enabled, build with "
+                                 "-DSCOLOR_WITH_WEBP -lwebp");
+#endif
+    } else if(o.format == "gif") {
+        return std::unique_ptr< ImageWriter >(new GIFWriter);
+    } else if(o.format == "bmp") {
+        return std::unique_ptr< ImageWriter >(new BMPWriter);
+    } else if(o.format == "ppm" || o.format == "raw") {
+        return std::unique_ptr< ImageWriter >(new PPMWriter(o.format == "ppm"));
+    }
+    throw std::runtime_error("Invalid image format " + o.format);
+}
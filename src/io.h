@@ -11,6 +11,8 @@
 
 #include "Vector3D.h"
 #include "hsvrgb.h"
+#include "CatmullRom.h"
+#include "ParallelFor.h"
 
 
 //-----------------------------------------------------------------------------
@@ -130,6 +132,26 @@ ScalarToRGB(const std::vector< ScalarT >& data,
 }
 
 //-----------------------------------------------------------------------------
+///Colorize [begin, end) into out, which must hold 3 * (end - begin) elements
+template < typename ScalarT >
+void CRKScalarToRGB(const ScalarT* begin,
+                    const ScalarT* end,
+                    ColorType* out,
+                    const std::vector< Vector3D< ScalarT > >& colors,
+                    const std::vector< ScalarT >& keys,
+                    ScalarT scalingFactor = ScalarT(1),
+                    ScalarT minVal = ScalarT(0),
+                    ScalarT maxVal = ScalarT(1)) {
+    const CompiledSpline< ScalarT > spline(colors, keys);
+    for(; begin != end; ++begin) {
+        const Vector3D< ScalarT > v = 
+            scalingFactor * spline(*begin, minVal, maxVal);
+        *out++ = ColorType(v[0]);
+        *out++ = ColorType(v[1]);
+        *out++ = ColorType(v[2]);
+    }
+}
+
 template < typename ScalarT >
 std::vector< ColorType >
 CRKScalarToRGB(const std::vector< ScalarT >& data,
@@ -138,21 +160,35 @@ CRKScalarToRGB(const std::vector< ScalarT >& data,
                ScalarT scalingFactor = ScalarT(1),
                ScalarT minVal = ScalarT(0),
                ScalarT maxVal = ScalarT(1)) {
-    std::vector< ColorType > out;
-    out.reserve(data.size() * 3);
-    for(auto d: data) {
-        const Vector3D< ScalarT > v = 
-            scalingFactor * KeyFramedCRomInterpolation(colors, keys, d, 
-                                                       minVal, maxVal);
-        out.push_back(ColorType(v[0]));
-        out.push_back(ColorType(v[1]));
-        out.push_back(ColorType(v[2]));
-    }
+    std::vector< ColorType > out(data.size() * 3);
+    CRKScalarToRGB(data.data(), data.data() + data.size(), out.data(),
+                   colors, keys, scalingFactor, minVal, maxVal);
     return out;
 }
 
 
 //-----------------------------------------------------------------------------
+///Colorize [begin, end) into out, which must hold 3 * (end - begin) elements
+template < typename ScalarT >
+void CRKScalarHSVToRGB(const ScalarT* begin,
+                       const ScalarT* end,
+                       ColorType* out,
+                       const std::vector< Vector3D< ScalarT > >& colors,
+                       const std::vector< ScalarT >& keys,
+                       ScalarT scalingFactor = ScalarT(1),
+                       ScalarT minVal = ScalarT(0),
+                       ScalarT maxVal = ScalarT(1)) {
+    const CompiledSpline< ScalarT > spline(colors, keys);
+    for(; begin != end; ++begin) {
+        const Vector3D< ScalarT > v = spline(*begin, minVal, maxVal);
+        hsv h(v[0], v[1], v[2]);
+        rgb c = hsv2rgb(h);                             
+        *out++ = ColorType(scalingFactor * c.r);
+        *out++ = ColorType(scalingFactor * c.g);
+        *out++ = ColorType(scalingFactor * c.b);
+    }
+}
+
 template < typename ScalarT >
 std::vector< ColorType >
 CRKScalarHSVToRGB(const std::vector< ScalarT >& data,
@@ -161,23 +197,34 @@ CRKScalarHSVToRGB(const std::vector< ScalarT >& data,
                ScalarT scalingFactor = ScalarT(1),
                ScalarT minVal = ScalarT(0),
                ScalarT maxVal = ScalarT(1)) {
-    std::vector< ColorType > out;
-    out.reserve(data.size() * 3);
-    for(auto d: data) {
-        const Vector3D< ScalarT > v = 
-                           KeyFramedCRomInterpolation(colors, keys, d, 
-                                                      minVal, maxVal);
-        hsv h(v[0], v[1], v[2]);
-        rgb c = hsv2rgb(h);                             
-        out.push_back(ColorType(scalingFactor * c.r));
-        out.push_back(ColorType(scalingFactor * c.g));
-        out.push_back(ColorType(scalingFactor * c.b));
-    }
+    std::vector< ColorType > out(data.size() * 3);
+    CRKScalarHSVToRGB(data.data(), data.data() + data.size(), out.data(),
+                      colors, keys, scalingFactor, minVal, maxVal);
     return out;
 }
 
 
 //-----------------------------------------------------------------------------
+///Colorize [begin, end) into out, which must hold 3 * (end - begin) elements
+template < typename ScalarT >
+void LScalarToRGB(const ScalarT* begin,
+                  const ScalarT* end,
+                  ColorType* out,
+                  const std::vector< Vector3D< ScalarT > >& colors,
+                  const std::vector< ScalarT >& keys,
+                  ScalarT normFactor = ScalarT(1),
+                  ScalarT minVal = ScalarT(0),
+                  ScalarT maxVal = ScalarT(1)) {
+    for(; begin != end; ++begin) {
+        const Vector3D< ScalarT > v = normFactor 
+                                   * LinearInterpolation(colors, keys, *begin, 
+                                                         minVal, maxVal);
+        *out++ = ColorType(v[0]);
+        *out++ = ColorType(v[1]);
+        *out++ = ColorType(v[2]);
+    }
+}
+
 template < typename ScalarT >
 std::vector< ColorType >
 LScalarToRGB(const std::vector< ScalarT >& data,
@@ -186,20 +233,36 @@ LScalarToRGB(const std::vector< ScalarT >& data,
              ScalarT normFactor = ScalarT(1),
              ScalarT minVal = ScalarT(0),
              ScalarT maxVal = ScalarT(1)) {
-    std::vector< ColorType > out;
-    out.reserve(data.size() * 3);
-    for(auto d: data) {
-        const Vector3D< ScalarT > v = normFactor 
-                                   * LinearInterpolation(colors, keys, d, 
-                                                         minVal, maxVal);
-        out.push_back(ColorType(v[0]));
-        out.push_back(ColorType(v[1]));
-        out.push_back(ColorType(v[2]));
-    }
+    std::vector< ColorType > out(data.size() * 3);
+    LScalarToRGB(data.data(), data.data() + data.size(), out.data(),
+                 colors, keys, normFactor, minVal, maxVal);
     return out;
 }
 
 //-----------------------------------------------------------------------------
+///Colorize [begin, end) into out, which must hold 3 * (end - begin) elements
+template < typename ScalarT >
+void LScalarHSVToRGB(const ScalarT* begin,
+                     const ScalarT* end,
+                     ColorType* out,
+                     const std::vector< Vector3D< ScalarT > >& colors,
+                     const std::vector< ScalarT >& keys,
+                     ScalarT normFactor = ScalarT(1),
+                     ScalarT minVal = ScalarT(0),
+                     ScalarT maxVal = ScalarT(1)) {
+    for(; begin != end; ++begin) {
+        const Vector3D< ScalarT > v =  
+                                     LinearInterpolation(colors, keys, *begin, 
+                                                         minVal, maxVal);
+        
+        hsv h(v[0], v[1], v[2]);
+        rgb c = hsv2rgb(h);                         
+        *out++ = ColorType(normFactor * c.r);
+        *out++ = ColorType(normFactor * c.g);
+        *out++ = ColorType(normFactor * c.b);
+    }
+}
+
 template < typename ScalarT >
 std::vector< ColorType >
 LScalarHSVToRGB(const std::vector< ScalarT >& data,
@@ -208,21 +271,60 @@ LScalarHSVToRGB(const std::vector< ScalarT >& data,
                 ScalarT normFactor = ScalarT(1),
                 ScalarT minVal = ScalarT(0),
                 ScalarT maxVal = ScalarT(1)) {
-    std::vector< ColorType > out;
-    out.reserve(data.size() * 3);
-    for(auto d: data) {
-        const Vector3D< ScalarT > v =  
-                                     LinearInterpolation(colors, keys, d, 
-                                                         minVal, maxVal);
-        
-        hsv h(v[0], v[1], v[2]);
-        rgb c = hsv2rgb(h);                         
-        out.push_back(ColorType(normFactor * c.r));
-        out.push_back(ColorType(normFactor * c.g));
-        out.push_back(ColorType(normFactor * c.b));
-    }
+    std::vector< ColorType > out(data.size() * 3);
+    LScalarHSVToRGB(data.data(), data.data() + data.size(), out.data(),
+                    colors, keys, normFactor, minVal, maxVal);
     return out;
 }
+
+//-----------------------------------------------------------------------------
+///Call kernel(const double* begin, const double* end, ColorType* out) on
+///[begin, end) converted to double in small blocks, for kernels that only
+///accept double data
+template < typename ScalarT, typename KernelT >
+void AsDouble(const ScalarT* begin, const ScalarT* end, ColorType* out,
+              KernelT kernel) {
+    const std::size_t blockSize = 1024;
+    double buf[blockSize];
+    while(begin != end) {
+        const std::size_t n = std::min(blockSize, std::size_t(end - begin));
+        std::copy(begin, begin + n, buf);
+        kernel(buf, buf + n, out);
+        begin += n;
+        out += 3 * n;
+    }
+}
+
+template < typename KernelT >
+void AsDouble(const double* begin, const double* end, ColorType* out,
+              KernelT kernel) {
+    kernel(begin, end, out);
+}
+
+//-----------------------------------------------------------------------------
+///Colorize a frame of @c size scalars across @c threads threads, the frame
+///is split into blocks of whole rows of @c rowSize elements scheduled
+///dynamically; kernel(begin, end, out) colorizes [begin, end) into out and
+///is typically one of the pointer based *ScalarToRGB overloads bound to its
+///colormap parameters. @c out must hold 3 * size elements.
+template < typename ScalarT, typename KernelT >
+void ParallelScalarToRGB(const ScalarT* data,
+                         std::size_t size,
+                         ColorType* out,
+                         std::size_t rowSize,
+                         int threads,
+                         KernelT kernel) {
+    //blocks of at least 64k pixels to amortize scheduling
+    const std::size_t minBlockSize = 1 << 16;
+    if(rowSize == 0) rowSize = 1;
+    const std::size_t rows = std::max(std::size_t(1), 
+                                      (minBlockSize + rowSize - 1) / rowSize);
+    ParallelFor(size, rows * rowSize, threads,
+                [&](std::size_t b, std::size_t e) {
+                    kernel(data + b, data + e, out + 3 * b);
+                });
+}
+
 //-----------------------------------------------------------------------------
 template < typename ScalarT >
 std::vector< ColorType >
@@ -244,20 +346,30 @@ SLScalarToRGB(const std::vector< ScalarT >& data,
     return out;
 }
 
+///Colorize [begin, end) into out, which must hold 3 * (end - begin) elements
+template < typename ScalarT >
+void ScalarToGray(const ScalarT* begin,
+                  const ScalarT* end,
+                  ColorType* out,
+                  ScalarT minVal,
+                  ScalarT maxVal,
+                  ScalarT normFactor = ScalarT(1)) {
+    for(; begin != end; ++begin) {
+        const ScalarT v = (*begin - minVal) / (maxVal - minVal);
+        *out++ = normFactor * v;
+        *out++ = normFactor * v;
+        *out++ = normFactor * v;
+    }
+}
+
 template < typename ScalarT >
 std::vector< ColorType >
 ScalarToGray(const std::vector< ScalarT >& data,
              ScalarT minVal,
              ScalarT maxVal,
              ScalarT normFactor = ScalarT(1)) {
-     std::vector< ColorType > out;
-     out.reserve(data.size() * 3);
-     for(auto d: data) {
-         const ScalarT v = (d - minVal) / (maxVal - minVal);
-        out.push_back(normFactor * v);
-        out.push_back(normFactor * v);
-        out.push_back(normFactor * v);
-     }
+     std::vector< ColorType > out(data.size() * 3);
+     ScalarToGray(data.data(), data.data() + data.size(), out.data(),
+                  minVal, maxVal, normFactor);
      return out;
 }
-
@@ -0,0 +1,116 @@
+//g++ -std=c++11 mapgen.cpp -o mapgen
+//cd ../maps && ../src/mapgen < builtin.txt > ../src/BuiltinMaps.h
+//Generate the constexpr tables of the built-in colormaps, see StaticColormap.h.
+//Input: one colormap per line, "<name> <file> [csv] [norm] [hsv] [dist]"
+//with the same meaning as the cmap options, file - is the default colormap;
+//empty lines and lines starting with # are skipped.
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "Colormap.h"
+
+using namespace std;
+
+struct Spec {
+    string name;
+    string file;
+    bool csv = false;
+    bool norm = false;
+    bool hsv = false;
+    bool dist = false;
+};
+
+void PrintTable(const char* name, const double* v, size_t n, int columns) {
+    printf("    static const double* %s() {\n", name);
+    printf("        static constexpr double t[] = {\n");
+    for(size_t i = 0; i != n; ++i) {
+        printf(i % columns == 0 ? "            " : " ");
+        printf("%.17g%s", v[i], i + 1 != n ? "," : "");
+        if(i % columns == size_t(columns - 1) || i + 1 == n) printf("\n");
+    }
+    printf("        };\n        return t;\n    }\n");
+}
+
+int main(int, char**) {
+    vector< Spec > specs;
+    string line;
+    while(getline(cin, line)) {
+        if(line.empty() || line[0] == '#') continue;
+        istringstream is(line);
+        Spec s;
+        is >> s.name >> s.file;
+        if(s.file.empty()) {
+            cerr << "Invalid line: " << line << endl;
+            return 1;
+        }
+        string option;
+        while(is >> option) {
+            if(option == "csv") s.csv = true;
+            else if(option == "norm") s.norm = true;
+            else if(option == "hsv") s.hsv = true;
+            else if(option == "dist") s.dist = true;
+            else {
+                cerr << "Invalid option: " << option << endl;
+                return 1;
+            }
+        }
+        specs.push_back(s);
+    }
+    printf("#pragma once\n");
+    printf("//Generated by mapgen from maps/builtin.txt, do not edit\n");
+    printf("#include <string>\n#include <vector>\n\n");
+    printf("#include \"StaticColormap.h\"\n\n");
+    printf("namespace builtin {\n");
+    for(const Spec& s: specs) {
+        const KeyData kd = ReadColormap(s.file == "-" ? string() : s.file,
+                                        s.csv, s.norm ? 1. / 255. : 1.,
+                                        s.hsv, s.dist);
+        const vector< Vector3D< double > >& colors = get< KEYFRAME::DATA >(kd);
+        const vector< double >& keys = get< KEYFRAME::KEYS >(kd);
+        if(colors.size() < 2 || colors.size() != keys.size()) {
+            cerr << "Invalid colormap: " << s.file << endl;
+            return 1;
+        }
+        vector< double > rgb;
+        for(const Vector3D< double >& c: colors) {
+            rgb.push_back(c[0]);
+            rgb.push_back(c[1]);
+            rgb.push_back(c[2]);
+        }
+        printf("//------------------------------------------------------------"
+               "------------------\n");
+        printf("///%s%s\n", s.file == "-" ? "default colormap"
+                                          : ("maps/" + s.file).c_str(),
+               s.hsv ? ", HSV" : "");
+        printf("struct %s {\n", s.name.c_str());
+        printf("    enum {SIZE = %zu, HSV = %d};\n", colors.size(),
+               int(s.hsv));
+        printf("    static const char* Id() { return \"%s\"; }\n",
+               s.name.c_str());
+        PrintTable("Colors", rgb.data(), rgb.size(), 3);
+        PrintTable("Keys", keys.data(), keys.size(), 4);
+        printf("};\n\n");
+    }
+    printf("} //namespace builtin\n\n");
+    printf("//------------------------------------------------------------"
+           "------------------\n");
+    printf("///All the built-in colormaps\n");
+    printf("inline const std::vector< BuiltinColormap >& BuiltinColormaps() {\n");
+    printf("    static const std::vector< BuiltinColormap > maps = {\n");
+    for(size_t i = 0; i != specs.size(); ++i) {
+        printf("        MakeBuiltinColormap< builtin::%s >()%s\n",
+               specs[i].name.c_str(), i + 1 != specs.size() ? "," : "");
+    }
+    printf("    };\n    return maps;\n}\n\n");
+    printf("///Built-in colormap @c name, nullptr if not found\n");
+    printf("inline const BuiltinColormap* "
+           "FindBuiltinColormap(const std::string& name) {\n");
+    printf("    for(const BuiltinColormap& m: BuiltinColormaps())\n");
+    printf("        if(name == m.name) return &m;\n");
+    printf("    return nullptr;\n}\n");
+    return 0;
+}
@@ -0,0 +1,24 @@
+#pragma once
+//Embeddable colorization API: include this header to colorize data from
+//memory and encode images without going through cmap and raw files.
+//
+//  Colormap map = Colormap::Load("../maps/CoolWarmFloat33.csv", true);
+//  std::vector< ColorType > rgb(3 * n);
+//  map.Colorize(data, n, rgb.data(), minVal, maxVal, threads);
+//  ImageOptions o;
+//  o.format = "png";
+//  MakeImageWriter(o)->Save(width, height, "frame.png", rgb.data());
+//
+//Built-in colormaps need no file, see BuiltinMaps.h:
+//
+//  const BuiltinColormap* b = FindBuiltinColormap("CoolWarmFloat33");
+//  Colormap map(b->Colors(), b->Keys());
+//
+//Images are stored bottom-up: the first row is the bottom row of the image.
+//Link with -lturbojpeg -ljpeg -lpng -lz, see scolor_c.h for the C interface.
+
+#include "Colormap.h"
+#include "BuiltinMaps.h"
+#include "Resample.h"
+#include "Statistics.h"
+#include "imageio.h"
@@ -0,0 +1,140 @@
+//g++ -std=c++11 -O2 -shared -fPIC -pthread scolor_c.cpp -lturbojpeg -ljpeg -lpng -lz -o libscolor.so
+//C interface of the scolor library, see scolor_c.h
+
+#include <string>
+#include <vector>
+#include <exception>
+
+#include "scolor.h"
+#include "scolor_c.h"
+
+struct scolor_colormap {
+    Colormap map;
+};
+
+namespace {
+thread_local std::string lastError;
+
+///Call f, translating exceptions into an error status
+template < typename F >
+int Guard(F f) {
+    try {
+        f();
+        return 0;
+    } catch(const std::exception& e) {
+        lastError = e.what();
+    } catch(...) {
+        lastError = "Unknown error";
+    }
+    return -1;
+}
+
+Colormap::Options MakeOptions(int flags, size_t lutSize) {
+    Colormap::Options o;
+    o.cubic = (flags & SCOLOR_CUBIC) != 0;
+    o.hsv = (flags & SCOLOR_HSV) != 0;
+    o.exact = (flags & SCOLOR_EXACT) != 0;
+    o.lutEnds = (flags & SCOLOR_LUT_ENDS) != 0;
+    if(lutSize) o.lutSize = lutSize;
+    return o;
+}
+
+template < typename T >
+int Colorize(const scolor_colormap* map, const T* data, size_t n,
+             T minVal, T maxVal, unsigned char* rgb, int threads) {
+    return Guard([&]() {
+        if(!map || (n && (!data || !rgb)))
+            throw std::logic_error("Invalid argument");
+        map->map.Colorize(data, n, rgb, minVal, maxVal,
+                          threads < 1 ? 1 : threads);
+    });
+}
+} //namespace
+
+extern "C" {
+
+scolor_colormap* scolor_colormap_create(const double* colors,
+                                        const double* keys, int n,
+                                        int flags, size_t lut_size) {
+    scolor_colormap* map = nullptr;
+    Guard([&]() {
+        if(!colors || n < 2) throw std::logic_error("Invalid colormap");
+        std::vector< Vector3D< double > > c;
+        for(int i = 0; i != n; ++i) {
+            c.push_back(Vector3D< double >(colors[3 * i], colors[3 * i + 1],
+                                           colors[3 * i + 2]));
+        }
+        std::vector< double > k;
+        if(keys) k.assign(keys, keys + n);
+        map = new scolor_colormap{Colormap(c, k, MakeOptions(flags,
+                                                             lut_size))};
+    });
+    return map;
+}
+
+scolor_colormap* scolor_colormap_load(const char* fname, int csv, int flags,
+                                      size_t lut_size) {
+    scolor_colormap* map = nullptr;
+    Guard([&]() {
+        if(!fname) throw std::logic_error("Invalid file name");
+        map = new scolor_colormap{Colormap::Load(fname, csv != 0,
+                                                 MakeOptions(flags,
+                                                             lut_size))};
+    });
+    return map;
+}
+
+void scolor_colormap_destroy(scolor_colormap* map) { delete map; }
+
+int scolor_colorize_f64(const scolor_colormap* map, const double* data,
+                        size_t n, double min, double max,
+                        unsigned char* rgb, int threads) {
+    return Colorize(map, data, n, min, max, rgb, threads);
+}
+
+int scolor_colorize_f32(const scolor_colormap* map, const float* data,
+                        size_t n, float min, float max,
+                        unsigned char* rgb, int threads) {
+    return Colorize(map, data, n, min, max, rgb, threads);
+}
+
+int scolor_colorize_u8(const scolor_colormap* map, const unsigned char* data,
+                       size_t n, unsigned char min, unsigned char max,
+                       unsigned char* rgb, int threads) {
+    return Colorize(map, data, n, min, max, rgb, threads);
+}
+
+int scolor_colorize_u16(const scolor_colormap* map,
+                        const unsigned short* data, size_t n,
+                        unsigned short min, unsigned short max,
+                        unsigned char* rgb, int threads) {
+    return Colorize(map, data, n, min, max, rgb, threads);
+}
+
+int scolor_colorize_i16(const scolor_colormap* map, const short* data,
+                        size_t n, short min, short max,
+                        unsigned char* rgb, int threads) {
+    return Colorize(map, data, n, min, max, rgb, threads);
+}
+
+int scolor_colorize_i32(const scolor_colormap* map, const int* data,
+                        size_t n, int min, int max,
+                        unsigned char* rgb, int threads) {
+    return Colorize(map, data, n, min, max, rgb, threads);
+}
+
+int scolor_write_image(const char* fname, const char* format, int width,
+                       int height, const unsigned char* rgb, int quality) {
+    return Guard([&]() {
+        if(!fname || !format || !rgb || width < 1 || height < 1)
+            throw std::logic_error("Invalid argument");
+        ImageOptions o;
+        o.format = format;
+        o.quality = quality;
+        MakeImageWriter(o)->Save(width, height, fname, rgb);
+    });
+}
+
+const char* scolor_last_error(void) { return lastError.c_str(); }
+
+} //extern "C"
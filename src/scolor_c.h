@@ -0,0 +1,66 @@
+#pragma once
+/* C interface of the scolor library, implemented in scolor_c.cpp:
+ *
+ *   g++ -std=c++11 -O2 -shared -fPIC -pthread scolor_c.cpp \
+ *       -lturbojpeg -ljpeg -lpng -lz -o libscolor.so
+ *
+ * Functions returning int return 0 on success and -1 on error, the error
+ * message of the calling thread is then returned by scolor_last_error.
+ * A colormap can be used by several threads at the same time. */
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct scolor_colormap scolor_colormap;
+
+enum {
+    SCOLOR_CUBIC     = 1, /* Catmull-Rom interpolation, default is linear */
+    SCOLOR_HSV       = 2, /* colors are HSV */
+    SCOLOR_EXACT     = 4, /* no lookup table */
+    SCOLOR_LUT_ENDS  = 8  /* min and max mapped to the exact end colors */
+};
+
+/* n colors, 3 * n values in [0, 1], and n sorted keys in [0, 1], evenly
+ * spaced if keys is NULL; lut_size = 0 selects the default size */
+scolor_colormap* scolor_colormap_create(const double* colors,
+                                        const double* keys, int n,
+                                        int flags, size_t lut_size);
+/* colormap file as read by cmap -f, csv != 0 for -csv */
+scolor_colormap* scolor_colormap_load(const char* fname, int csv, int flags,
+                                      size_t lut_size);
+void scolor_colormap_destroy(scolor_colormap* map);
+
+/* colorize n values into rgb, which must hold 3 * n bytes; [min, max] is
+ * mapped to the colormap */
+int scolor_colorize_f64(const scolor_colormap* map, const double* data,
+                        size_t n, double min, double max,
+                        unsigned char* rgb, int threads);
+int scolor_colorize_f32(const scolor_colormap* map, const float* data,
+                        size_t n, float min, float max,
+                        unsigned char* rgb, int threads);
+int scolor_colorize_u8(const scolor_colormap* map, const unsigned char* data,
+                       size_t n, unsigned char min, unsigned char max,
+                       unsigned char* rgb, int threads);
+int scolor_colorize_u16(const scolor_colormap* map,
+                        const unsigned short* data, size_t n,
+                        unsigned short min, unsigned short max,
+                        unsigned char* rgb, int threads);
+int scolor_colorize_i16(const scolor_colormap* map, const short* data,
+                        size_t n, short min, short max,
+                        unsigned char* rgb, int threads);
+int scolor_colorize_i32(const scolor_colormap* map, const int* data,
+                        size_t n, int min, int max,
+                        unsigned char* rgb, int threads);
+
+/* encode the bottom-up width x height RGB image into fname; format is jpg,
+ * png, webp, bmp, ppm or raw, quality applies to JPEG and WebP */
+int scolor_write_image(const char* fname, const char* format, int width,
+                       int height, const unsigned char* rgb, int quality);
+
+const char* scolor_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif